@@ -0,0 +1,34 @@
+#include "GBitmap.h"
+#include "GPixel.h"
+
+#include "BitmapKey.h"
+
+
+// FNV-1a's prime, used to mix each pixel into a running checksum.
+static const uint32_t kChecksumPrime = 16777619;
+
+
+BitmapKey BitmapKey::Make(const GBitmap& bitmap) {
+    // Four checksums are kept, one for every fourth pixel of a row, so that
+    // each multiply doesn't have to wait on the one before it.
+    uint32_t sums[4] = { 2166136261u, 2166136261u, 2166136261u, 2166136261u };
+    for (int y = 0; y < bitmap.height(); ++y) {
+        const GPixel* row = bitmap.getAddr(0, y);
+        int x = 0;
+        for (; x + 4 <= bitmap.width(); x += 4) {
+            for (int i = 0; i < 4; ++i) {
+                sums[i] = (sums[i] ^ row[x + i]) * kChecksumPrime;
+            }
+        }
+        for (; x < bitmap.width(); ++x) {
+            sums[0] = (sums[0] ^ row[x]) * kChecksumPrime;
+        }
+    }
+
+    uint32_t checksum = sums[0];
+    for (int i = 1; i < 4; ++i) {
+        checksum = (checksum ^ sums[i]) * kChecksumPrime;
+    }
+
+    return { bitmap.pixels(), bitmap.width(), bitmap.height(), bitmap.rowBytes(), checksum };
+}
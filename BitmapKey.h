@@ -0,0 +1,40 @@
+#ifndef BitmapKey_DEFINED
+#define BitmapKey_DEFINED
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "GBitmap.h"
+#include "GPixel.h"
+
+
+/**
+ * Identifies the pixels a copy of a bitmap was made from, so the copy can be
+ * reused only while they're the same. The pointer and layout alone aren't
+ * enough: the pixels may be drawn into after the copy is made, or freed and
+ * their memory handed to another bitmap, so a checksum of the contents is
+ * kept as well.
+ */
+struct BitmapKey {
+    /**
+     * Describe a bitmap's current pixels. This reads every one of them.
+     */
+    static BitmapKey Make(const GBitmap& bitmap);
+
+    bool operator==(const BitmapKey& other) const {
+        return this->fPixels == other.fPixels && this->fWidth == other.fWidth
+            && this->fHeight == other.fHeight && this->fRowBytes == other.fRowBytes
+            && this->fChecksum == other.fChecksum;
+    }
+
+    bool operator!=(const BitmapKey& other) const { return !(*this == other); }
+
+    const GPixel* fPixels;
+    int fWidth;
+    int fHeight;
+    size_t fRowBytes;
+    uint32_t fChecksum;
+};
+
+
+#endif
@@ -1,14 +1,216 @@
+#include <algorithm>
+#include <list>
+#include <math.h>
+#include <memory>
+#include <mutex>
+#include <string.h>
+
 #include "GBitmap.h"
 #include "GMatrix.h"
 #include "GShader.h"
 
+#include "BitmapKey.h"
+#include "Mipmap.h"
+#include "SIMD.h"
+#include "SwizzledBitmap.h"
+
+
+// Bilinear weights are measured in sixteenths of a texel, so that the four
+// weights of a sample are products that sum to 256.
+static const int kSubpixelBits = 4;
+static const int kSubpixelMask = (1 << kSubpixelBits) - 1;
+static const int kSubpixelOne = 1 << kSubpixelBits;
+
+
+// Nearest sampling of repeated and mirrored bitmaps steps through them in
+// 16.16 fixed point. A coordinate plus a step can reach almost two tiling
+// periods before it is wrapped, which only fits in an int32_t as long as the
+// period is shorter than kFixedMaxPeriod texels.
+static const int kFixedBits = 16;
+static const int kFixedMaxPeriod = 1 << 14;
+
+
+// Bitmaps with fewer texels than this fit in cache however they are walked,
+// so rotated sampling only reads a swizzled copy of larger bitmaps.
+static const int kSwizzleMinTexels = 256 * 256;
+
+
+// How many mip chains and swizzled copies are kept around for later draws.
+static const int kMipmapCacheCount = 4;
+static const int kSwizzledCacheCount = 4;
+
+
+/**
+ * Copies made from bitmaps, such as mip chains, shared by every shader that
+ * draws the same pixels. Only the most recently used few are kept.
+ */
+template <typename Copy, int kCount>
+class BitmapCopyCache {
+public:
+    /**
+     * Find the copy of a bitmap's current pixels, making it if it isn't
+     * cached.
+     */
+    std::shared_ptr<const Copy> find(const GBitmap& bitmap) {
+        BitmapKey key = BitmapKey::Make(bitmap);
+        std::lock_guard<std::mutex> lock(this->fMutex);
+        for (auto it = this->fEntries.begin(); it != this->fEntries.end(); ++it) {
+            if (it->key == key) {
+                this->fEntries.splice(this->fEntries.begin(), this->fEntries, it);
+                return it->copy;
+            }
+        }
+
+        this->fEntries.push_front({ key, std::make_shared<const Copy>(bitmap) });
+        if ((int) this->fEntries.size() > kCount) {
+            this->fEntries.pop_back();
+        }
+        return this->fEntries.front().copy;
+    }
+
+private:
+    struct Entry {
+        BitmapKey key;
+        std::shared_ptr<const Copy> copy;
+    };
+
+    std::mutex fMutex;
+    std::list<Entry> fEntries;          // most recently used first
+};
+
+
+/**
+ * Convert a texel coordinate to 16.16 fixed point, wrapped into [0, period).
+ */
+static inline int32_t toPeriodFixed(float u, int period) {
+    float wrapped = u - period * floorf(u / period);
+    int32_t fixed = (int32_t) (wrapped * (1 << kFixedBits));
+
+    // Wrapping can round up to the period itself.
+    return std::max(0, std::min((period << kFixedBits) - 1, fixed));
+}
+
+
+/**
+ * Find how far a lane of four-pixel-wide steps moves through a period, in
+ * 16.16 fixed point, given how far one pixel moves in texels.
+ *
+ * Returns:
+ *     A step in [0, period), equivalent to four steps of du.
+ */
+static inline int32_t periodStep(float du, int period) {
+    int64_t fixedPeriod = (int64_t) period << kFixedBits;
+    int64_t step = (int64_t) llroundf(du * (1 << kFixedBits)) * 4 % fixedPeriod;
+
+    return (int32_t) (step < 0 ? step + fixedPeriod : step);
+}
+
+
+/**
+ * Find the texel that a whole texel coordinate reads from under a tile mode.
+ * The mode is a template parameter so that sampling loops don't branch on it
+ * for every tap.
+ *
+ * Args:
+ *     i:
+ *         The texel coordinate, which may lie outside the bitmap.
+ *     size:
+ *         The width or height of the bitmap.
+ *
+ * Returns:
+ *     A coordinate in [0, size).
+ */
+template <GShader::TileMode tile> static inline int tileTexel(int i, int size) {
+    switch (tile) {
+        case GShader::kRepeat:
+            i %= size;
+            return i < 0 ? i + size : i;
+        case GShader::kMirror: {
+            int period = 2 * size;
+            i %= period;
+            if (i < 0) {
+                i += period;
+            }
+            return i < size ? i : period - 1 - i;
+        }
+        default:
+            return std::max(0, std::min(size - 1, i));
+    }
+}
+
+
+/**
+ * Find the texels that the whole texel coordinates i and i + 1 read from
+ * under a tile mode, without dividing.
+ *
+ * Args:
+ *     i:
+ *         The first coordinate. When repeating or mirroring, it must already
+ *         be wrapped into one period of the tiling: [0, size) when
+ *         repeating, and [0, 2 * size) when mirroring.
+ *     size:
+ *         The width or height of the bitmap.
+ *     first, second:
+ *         Set to the texels that i and i + 1 read from.
+ */
+template <GShader::TileMode tile> static inline void tileTexelPair(
+        int i, int size, int* first, int* second) {
+    switch (tile) {
+        case GShader::kRepeat:
+            *first = i;
+            *second = i + 1 == size ? 0 : i + 1;
+            break;
+        case GShader::kMirror: {
+            int period = 2 * size;
+            int next = i + 1 == period ? 0 : i + 1;
+            *first = i < size ? i : period - 1 - i;
+            *second = next < size ? next : period - 1 - next;
+            break;
+        }
+        default:
+            *first = tileTexel<GShader::kClamp>(i, size);
+            *second = tileTexel<GShader::kClamp>(i + 1, size);
+            break;
+    }
+}
+
+
+/**
+ * Wrap a 16.16 fixed point value into [0, period), where period is also in
+ * 16.16 fixed point.
+ */
+static inline int64_t wrapFixed(int64_t value, int64_t period) {
+    value %= period;
+    return value < 0 ? value + period : value;
+}
+
+
+/**
+ * Equivalent to tileTexel, for a tile mode that is only known at runtime.
+ */
+static inline int tileTexel(int i, int size, GShader::TileMode tile) {
+    switch (tile) {
+        case GShader::kRepeat:
+            return tileTexel<GShader::kRepeat>(i, size);
+        case GShader::kMirror:
+            return tileTexel<GShader::kMirror>(i, size);
+        default:
+            return tileTexel<GShader::kClamp>(i, size);
+    }
+}
+
 
 class BitmapShader : public GShader {
 public:
-    BitmapShader(const GBitmap& bitmap, const GMatrix& localInv, GShader::TileMode tile)
+    BitmapShader(const GBitmap& bitmap, const GMatrix& localInv, GShader::TileMode tile,
+                 GShader::FilterQuality quality)
         : fSourceBitmap(bitmap)
         , fLocalMatrix(localInv)
-        , fTile(tile) {}
+        , fTile(tile)
+        , fQuality(quality)
+        , fTranslateOnly(false)
+        , fTranslateX(0)
+        , fTranslateY(0) {}
 
     bool isOpaque() override {
         return false;
@@ -21,71 +223,365 @@ public:
 
         fInverse.postConcat(fLocalMatrix);
 
+        // Below half scale, sample the mip level whose texels are about the
+        // size of a pixel. The chain is looked up by the bitmap's current
+        // pixels, so it's rebuilt whenever they change.
+        fLevel = fSourceBitmap;
+        float texelsPerPixel = std::max(hypotf(fInverse[GMatrix::SX], fInverse[GMatrix::KY]),
+                                        hypotf(fInverse[GMatrix::KX], fInverse[GMatrix::SY]));
+        if (texelsPerPixel >= 2) {
+            static BitmapCopyCache<Mipmap, kMipmapCacheCount> mipmaps;
+            fMipmap = mipmaps.find(fSourceBitmap);
+            fLevel = fMipmap->level(fMipmap->levelFor(texelsPerPixel));
+            fInverse.postScale((float) fLevel.width() / fSourceBitmap.width(),
+                               (float) fLevel.height() / fSourceBitmap.height());
+        }
+
+        // When the bitmap is only moved by whole pixels, every pixel center
+        // lands on a texel center, so either filter reads single texels and
+        // rows of the bitmap can be copied as they are.
+        fTranslateOnly = fInverse[GMatrix::SX] == 1 && fInverse[GMatrix::KX] == 0
+            && fInverse[GMatrix::KY] == 0 && fInverse[GMatrix::SY] == 1
+            && fInverse[GMatrix::TX] == floorf(fInverse[GMatrix::TX])
+            && fInverse[GMatrix::TY] == floorf(fInverse[GMatrix::TY]);
+        if (fTranslateOnly) {
+            fTranslateX = (int) fInverse[GMatrix::TX];
+            fTranslateY = (int) fInverse[GMatrix::TY];
+        }
+
+        // Rows that cut across the rows of a large bitmap are sampled from a
+        // copy of it stored in tiles, which is kept for as long as the level's
+        // pixels stay the same.
+        fSwizzled.reset();
+        bool rotated = fInverse[GMatrix::KY] != 0;
+        bool large = (int64_t) fLevel.width() * fLevel.height() >= kSwizzleMinTexels;
+        if (fQuality == FilterQuality::kNearest && rotated && large) {
+            static BitmapCopyCache<SwizzledBitmap, kSwizzledCacheCount> swizzled;
+            fSwizzled = swizzled.find(fLevel);
+        }
+
         return true;
     }
 
     void shadeRow(int x, int y, int count, GPixel row[]) override {
+        if (fTranslateOnly) {
+            this->shadeRowTranslate(x, y, count, row);
+            return;
+        }
+
+        if (fQuality == FilterQuality::kBilinear) {
+            switch (fTile) {
+                case TileMode::kClamp:
+                    this->shadeRowBilinear<TileMode::kClamp>(x, y, count, row);
+                    break;
+                case TileMode::kRepeat:
+                    this->shadeRowBilinear<TileMode::kRepeat>(x, y, count, row);
+                    break;
+                case TileMode::kMirror:
+                    this->shadeRowBilinear<TileMode::kMirror>(x, y, count, row);
+                    break;
+            }
+            return;
+        }
+
+        if (fSwizzled) {
+            this->shadeRowNearest(x, y, count, row, *fSwizzled);
+        } else {
+            this->shadeRowNearest(x, y, count, row, RowMajorTexels(fLevel));
+        }
+    }
+
+private:
+    /**
+     * Shade a row with nearest sampling, reading texels from either the
+     * bitmap being sampled or a swizzled copy of it.
+     */
+    template <typename Texels> void shadeRowNearest(
+            int x, int y, int count, GPixel row[], const Texels& texels) {
+        // Repeating and mirroring step through the bitmap in fixed point, as
+        // long as a whole period of the tiling fits in it.
+        const int periodScale = fTile == TileMode::kMirror ? 2 : 1;
+        bool fitsFixed = std::max(fLevel.width(), fLevel.height()) * periodScale < kFixedMaxPeriod;
+        if (fTile == TileMode::kRepeat && fitsFixed) {
+            this->shadeRowTiled<TileMode::kRepeat>(x, y, count, row, texels);
+            return;
+        }
+        if (fTile == TileMode::kMirror && fitsFixed) {
+            this->shadeRowTiled<TileMode::kMirror>(x, y, count, row, texels);
+            return;
+        }
+        if (fTile == TileMode::kClamp) {
+            this->shadeRowClamped(x, y, count, row, texels);
+            return;
+        }
+
+        const GPixel* pixels = texels.pixels();
         GPoint local = fInverse.mapXY(x + 0.5f, y + 0.5f);
 
         for (int i = 0; i < count; ++i) {
-            int sourceX = GRoundToInt(local.fX);
-            int sourceY = GRoundToInt(local.fY);
+            int sourceX = tileTexel(GFloorToInt(local.fX), fLevel.width(), fTile);
+            int sourceY = tileTexel(GFloorToInt(local.fY), fLevel.height(), fTile);
 
-            if (fTile == TileMode::kRepeat) {
-                sourceX %= fSourceBitmap.width();
-                if (sourceX < 0) {
-                    sourceX += fSourceBitmap.width();
-                }
+            row[i] = pixels[texels.offset(sourceX, sourceY)];
 
-                sourceY %= fSourceBitmap.height();
-                if (sourceY < 0) {
-                    sourceY += fSourceBitmap.height();
-                }
-            } else if (fTile == TileMode::kMirror) {
-                float x1 = local.fX / fSourceBitmap.width();
-                float y1 = local.fY / fSourceBitmap.height();
-
-                x1 *= .5;
-                x1 = x1 - floor(x1);
-                if (x1 > .5) {
-                    x1 = 1 - x1;
-                }
-                x1 *= 2;
+            local.fX += fInverse[GMatrix::SX];
+            local.fY += fInverse[GMatrix::KY];
+        }
+    }
 
-                y1 *= .5;
-                y1 = y1 - floor(y1);
-                if (y1 > .5) {
-                    y1 = 1 - y1;
-                }
-                y1 *= 2;
+    /**
+     * Shade a row of a clamped bitmap with nearest sampling, four pixels at
+     * a time.
+     */
+    template <typename Texels> void shadeRowClamped(
+            int x, int y, int count, GPixel row[], const Texels& texels) {
+        GPoint local = fInverse.mapXY(x + 0.5f, y + 0.5f);
+        const float du = fInverse[GMatrix::SX];
+        const float dv = fInverse[GMatrix::KY];
+
+        const Float4 lanes = { 0, 1, 2, 3 };
+        Float4 u = Float4_Splat(local.fX) + lanes * Float4_Splat(du);
+        Float4 v = Float4_Splat(local.fY) + lanes * Float4_Splat(dv);
+        const Float4 stepU = Float4_Splat(4 * du);
+        const Float4 stepV = Float4_Splat(4 * dv);
 
-                sourceX = GRoundToInt(x1 * fSourceBitmap.width());
-                sourceY = GRoundToInt(y1 * fSourceBitmap.height());
+        const Int4 zero = Int4_Splat(0);
+        const Int4 maxX = Int4_Splat(fLevel.width() - 1);
+        const Int4 maxY = Int4_Splat(fLevel.height() - 1);
+        const GPixel* pixels = texels.pixels();
+
+        for (int i = 0; i < count; i += 4) {
+            Int4 texelX = Float4_FloorToInt(u);
+            Int4 texelY = Float4_FloorToInt(v);
+            texelX = Int4_Select(texelX < zero, zero, Int4_Select(texelX > maxX, maxX, texelX));
+            texelY = Int4_Select(texelY < zero, zero, Int4_Select(texelY > maxY, maxY, texelY));
+
+            Int4 offset = texels.offset4(texelX, texelY);
+            int pixelCount = std::min(4, count - i);
+            for (int k = 0; k < pixelCount; ++k) {
+                row[i + k] = pixels[offset[k]];
             }
 
-            // Clamp values
-            sourceX = std::max(0, std::min(fSourceBitmap.width() - 1, sourceX));
-            sourceY = std::max(0, std::min(fSourceBitmap.height() - 1, sourceY));
+            u += stepU;
+            v += stepV;
+        }
+    }
+
+    /**
+     * Shade a row of a repeated or mirrored bitmap with nearest sampling,
+     * four pixels at a time.
+     *
+     * Each lane keeps its coordinates in 16.16 fixed point, wrapped into one
+     * period of the tiling: the width of the bitmap when repeating, or twice
+     * it when mirroring. Stepping four pixels is then one add per lane, and
+     * at most one period has to be subtracted to wrap the result again, so
+     * no lane ever divides. A mirrored coordinate in the second half of its
+     * period is reflected back into the bitmap just before it is read.
+     */
+    template <TileMode tile, typename Texels> void shadeRowTiled(
+            int x, int y, int count, GPixel row[], const Texels& texels) {
+        const int width = fLevel.width();
+        const int height = fLevel.height();
+        const int periodX = tile == TileMode::kMirror ? 2 * width : width;
+        const int periodY = tile == TileMode::kMirror ? 2 * height : height;
 
-            row[i] = *fSourceBitmap.getAddr(sourceX, sourceY);
+        GPoint local = fInverse.mapXY(x + 0.5f, y + 0.5f);
+        const float du = fInverse[GMatrix::SX];
+        const float dv = fInverse[GMatrix::KY];
 
-            local.fX += fInverse[GMatrix::SX];
-            local.fY += fInverse[GMatrix::KY];
+        Int4 fixedU, fixedV;
+        for (int k = 0; k < 4; ++k) {
+            fixedU[k] = toPeriodFixed(local.fX + k * du, periodX);
+            fixedV[k] = toPeriodFixed(local.fY + k * dv, periodY);
+        }
+
+        const Int4 limitU = Int4_Splat(periodX << kFixedBits);
+        const Int4 limitV = Int4_Splat(periodY << kFixedBits);
+        const Int4 stepU = Int4_Splat(periodStep(du, periodX));
+        const Int4 stepV = Int4_Splat(periodStep(dv, periodY));
+        const GPixel* pixels = texels.pixels();
+
+        for (int i = 0; i < count; i += 4) {
+            Int4 texelX = fixedU >> kFixedBits;
+            Int4 texelY = fixedV >> kFixedBits;
+            if (tile == TileMode::kMirror) {
+                texelX = Int4_Select(texelX >= width, Int4_Splat(periodX - 1) - texelX, texelX);
+                texelY = Int4_Select(texelY >= height, Int4_Splat(periodY - 1) - texelY, texelY);
+            }
+
+            Int4 offset = texels.offset4(texelX, texelY);
+            int pixelCount = std::min(4, count - i);
+            for (int k = 0; k < pixelCount; ++k) {
+                row[i + k] = pixels[offset[k]];
+            }
+
+            // Both the coordinates and the steps are within a period, so
+            // their sums are less than two periods.
+            fixedU += stepU;
+            fixedV += stepV;
+            fixedU -= limitU & (fixedU >= limitU);
+            fixedV -= limitV & (fixedV >= limitV);
+        }
+    }
+
+    /**
+     * Shade a row of a bitmap that is only translated, by copying runs of
+     * texels straight out of the source row. Tiling is worked out once per
+     * run rather than once per pixel: a run ends where the row leaves the
+     * bitmap, wraps around, or turns back on itself.
+     */
+    void shadeRowTranslate(int x, int y, int count, GPixel row[]) {
+        const int width = fLevel.width();
+        const GPixel* src = fLevel.getAddr(0, tileTexel(y + fTranslateY, fLevel.height(), fTile));
+        int sx = x + fTranslateX;
+
+        while (count > 0) {
+            // Mirrored copies of the bitmap run backwards.
+            bool backwards = fTile == TileMode::kMirror
+                && tileTexel<TileMode::kRepeat>(sx, 2 * width) >= width;
+
+            int run;
+            if (fTile == TileMode::kClamp && (sx < 0 || sx >= width)) {
+                GPixel edge = sx < 0 ? src[0] : src[width - 1];
+                run = sx < 0 ? std::min(count, -sx) : count;
+                std::fill(row, row + run, edge);
+            } else if (backwards) {
+                int start = tileTexel<TileMode::kMirror>(sx, width);
+                run = std::min(count, start + 1);
+                for (int i = 0; i < run; ++i) {
+                    row[i] = src[start - i];
+                }
+            } else {
+                int start = tileTexel(sx, width, fTile);
+                run = std::min(count, width - start);
+                memcpy(row, src + start, run * sizeof(GPixel));
+            }
+
+            row += run;
+            count -= run;
+            sx += run;
+        }
+    }
+
+    /**
+     * Shade a row by blending the four texels around each pixel's center.
+     *
+     * Texel centers sit at half-integer coordinates, so a pixel that maps to
+     * (u, v) lies between the texels whose corners are at floor(u - 0.5) and
+     * floor(v - 0.5). The fractions past those corners are kept in fixed point
+     * and become the weights of the texels, and the blend for two pixels is
+     * done at once with their channels widened to 16 bits.
+     */
+    template <TileMode tile> void shadeRowBilinear(int x, int y, int count, GPixel row[]) {
+        const int width = fLevel.width();
+        const int height = fLevel.height();
+
+        // Positions step along the row in 16.16 fixed point, with 64 bits so
+        // that clamped rows can run far outside the bitmap.
+        GPoint local = fInverse.mapXY(x + 0.5f, y + 0.5f);
+        int64_t u = llroundf((local.fX - 0.5f) * (1 << kFixedBits));
+        int64_t v = llroundf((local.fY - 0.5f) * (1 << kFixedBits));
+        int64_t du = llroundf(fInverse[GMatrix::SX] * (1 << kFixedBits));
+        int64_t dv = llroundf(fInverse[GMatrix::KY] * (1 << kFixedBits));
+        const int fracShift = kFixedBits - kSubpixelBits;
+
+        // Repeated and mirrored positions are kept within one period of the
+        // tiling, so that finding their texels never divides.
+        const int periodScale = tile == TileMode::kMirror ? 2 : 1;
+        const int64_t periodU = (int64_t) (periodScale * width) << kFixedBits;
+        const int64_t periodV = (int64_t) (periodScale * height) << kFixedBits;
+        const bool wraps = tile != TileMode::kClamp;
+        if (wraps) {
+            u = wrapFixed(u, periodU);
+            v = wrapFixed(v, periodV);
+            du = wrapFixed(du, periodU);
+            dv = wrapFixed(dv, periodV);
+        }
+
+        // The taps and weights of the two pixels being blended, with the
+        // first pixel in the low lanes.
+        GPixel taps[4][2];
+        uint16_t weights[4][2];
+
+        for (int i = 0; i < count; i += 2) {
+            int pixels = std::min(2, count - i);
+
+            for (int p = 0; p < 2; ++p) {
+                // A lone last pixel fills both lanes with the same sample.
+                if (p < pixels) {
+                    int fracX = (int) (u >> fracShift) & kSubpixelMask;
+                    int fracY = (int) (v >> fracShift) & kSubpixelMask;
+
+                    int x0, x1, y0, y1;
+                    tileTexelPair<tile>((int) (u >> kFixedBits), width, &x0, &x1);
+                    tileTexelPair<tile>((int) (v >> kFixedBits), height, &y0, &y1);
+                    const GPixel* row0 = fLevel.getAddr(0, y0);
+                    const GPixel* row1 = fLevel.getAddr(0, y1);
+
+                    taps[0][p] = row0[x0];
+                    taps[1][p] = row0[x1];
+                    taps[2][p] = row1[x0];
+                    taps[3][p] = row1[x1];
+
+                    weights[0][p] = (kSubpixelOne - fracX) * (kSubpixelOne - fracY);
+                    weights[1][p] = fracX * (kSubpixelOne - fracY);
+                    weights[2][p] = (kSubpixelOne - fracX) * fracY;
+                    weights[3][p] = fracX * fracY;
+
+                    u += du;
+                    v += dv;
+                    if (wraps) {
+                        u -= u >= periodU ? periodU : 0;
+                        v -= v >= periodV ? periodV : 0;
+                    }
+                } else {
+                    for (int t = 0; t < 4; ++t) {
+                        taps[t][p] = taps[t][0];
+                        weights[t][p] = weights[t][0];
+                    }
+                }
+            }
+
+            // Each channel is at most 255 * 256 once weighted, so the sum
+            // fits in 16 bits before it is scaled back down.
+            U16x8 sum = { 0 };
+            for (int t = 0; t < 4; ++t) {
+                uint16_t w0 = weights[t][0];
+                uint16_t w1 = weights[t][1];
+                U16x8 w = { w0, w0, w0, w0, w1, w1, w1, w1 };
+                sum += U16x8_Expand(taps[t][0], taps[t][1]) * w;
+            }
+
+            GPixel blended[2];
+            U16x8_Pack(sum >> 8, blended);
+            row[i] = blended[0];
+            if (pixels > 1) {
+                row[i + 1] = blended[1];
+            }
         }
     }
 
-private:
     GBitmap fSourceBitmap;
+    GBitmap fLevel;                             // the bitmap or mip level being sampled
+    std::shared_ptr<const Mipmap> fMipmap;
+    std::shared_ptr<const SwizzledBitmap> fSwizzled;    // the copy of fLevel to sample, if any
     GMatrix fInverse;
     GMatrix fLocalMatrix;
     TileMode fTile;
+    FilterQuality fQuality;
+
+    // Set when the inverse matrix only translates by whole texels.
+    bool fTranslateOnly;
+    int fTranslateX;
+    int fTranslateY;
 };
 
 
-std::unique_ptr<GShader> GCreateBitmapShader(const GBitmap& bitmap, const GMatrix& localInv, GShader::TileMode tile) {
+std::unique_ptr<GShader> GCreateBitmapShader(const GBitmap& bitmap, const GMatrix& localInv, GShader::TileMode tile,
+                                             GShader::FilterQuality quality) {
     if (!bitmap.pixels()) {
         return nullptr;
     }
 
-    return std::unique_ptr<GShader>(new BitmapShader(bitmap, localInv, tile));
+    return std::unique_ptr<GShader>(new BitmapShader(bitmap, localInv, tile, quality));
 }
@@ -219,3 +219,17 @@ BlendProc Blend_GetProc(const GBlendMode mode) {
 BlendProc Blend_GetProc(const GBlendMode mode, const GPixel src) {
     return Blend_GetProc(mode);
 }
+
+
+GPixel Blend_Lerp(const GPixel from, const GPixel to, int weight) {
+    GASSERT(0 <= weight && weight <= 255);
+
+    int inverse = 255 - weight;
+
+    int alpha = multiplyBytes(weight, GPixel_GetA(to)) + multiplyBytes(inverse, GPixel_GetA(from));
+    int red = multiplyBytes(weight, GPixel_GetR(to)) + multiplyBytes(inverse, GPixel_GetR(from));
+    int green = multiplyBytes(weight, GPixel_GetG(to)) + multiplyBytes(inverse, GPixel_GetG(from));
+    int blue = multiplyBytes(weight, GPixel_GetB(to)) + multiplyBytes(inverse, GPixel_GetB(from));
+
+    return GPixel_PackARGB(alpha, red, green, blue);
+}
@@ -73,4 +73,21 @@ BlendProc Blend_GetProc(const GBlendMode mode);
 BlendProc Blend_GetProc(const GBlendMode mode, const GPixel src);
 
 
+/**
+ * Linearly interpolate between two pixels.
+ *
+ * Args:
+ *     from:
+ *         The pixel returned for a weight of 0.
+ *     to:
+ *         The pixel returned for a weight of 255.
+ *     weight:
+ *         How far to move from 'from' towards 'to', in the range [0, 255].
+ *
+ * Returns:
+ *     The interpolated pixel.
+ */
+GPixel Blend_Lerp(const GPixel from, const GPixel to, int weight);
+
+
 #endif
@@ -1,8 +1,44 @@
+#include <algorithm>
+
 #include "Clipper.h"
+#include "SIMD.h"
+
+
+// How far outside of the horizontal clipping bounds an edge may extend before
+// we actually clip it. This only exists to keep the x-coordinates of edges in a
+// range where floats are still precise to well under a pixel.
+static const float kGuardBand = 1 << 14;
+
+
+/**
+ * Point an edge at a new segment, leaving its winding alone. The segment must
+ * already be ordered so that p0.y <= p1.y.
+ *
+ * Returns:
+ *     A boolean indicating if the segment crosses a pixel center vertically.
+ */
+static bool setSegment(Edge* edge, GPoint p0, GPoint p1) {
+    edge->topY = GRoundToInt(p0.y());
+    edge->bottomY = GRoundToInt(p1.y());
+
+    if (edge->topY == edge->bottomY) {
+        return false;
+    }
+
+    // The slope has to come from the segment itself rather than the rows it
+    // covers, or short segments (such as those of a curve) are badly skewed.
+    edge->dxdy = (p1.x() - p0.x()) / (p1.y() - p0.y());
+
+    float dx = edge->dxdy * (edge->topY - p0.y() + 0.5f);
+    edge->curX = p0.x() + dx;
+
+    return true;
+}
 
 
 bool Edge::init(GPoint p0, GPoint p1, int wind) {
     this->wind = wind;
+    this->curve = -1;
 
     // Ensure p0.y <= p1.y
     if (p0.y() > p1.y()) {
@@ -10,23 +46,213 @@ bool Edge::init(GPoint p0, GPoint p1, int wind) {
         this->wind = -this->wind;
     }
 
-    this->topY = GRoundToInt(p0.y());
-    this->bottomY = GRoundToInt(p1.y());
+    return setSegment(this, p0, p1);
+}
+
+
+/**
+ * Step a curve forward by one segment.
+ *
+ * Returns:
+ *     The end of the segment, which is also the curve's new 'pt'.
+ */
+static GPoint stepCurve(CurveEdge* curve) {
+    GPoint prev = curve->pt;
+
+    curve->count--;
+    if (curve->count == 0) {
+        // Land exactly on the end point so contours stay closed.
+        curve->pt = curve->end;
+    } else {
+        curve->pt += curve->d1;
+        curve->d1 = curve->d1 + curve->d2;
+        curve->d2 = curve->d2 + curve->d3;
+    }
+
+    // Rounding error must never make a monotonic curve step backwards, since
+    // that would flip the winding of the segment.
+    curve->pt.fY = std::max(curve->pt.y(), prev.y());
+
+    return curve->pt;
+}
+
+
+/**
+ * Point an edge at the segment of its curve from p0 to p1, clipping it to the
+ * bottom of the bounds. A segment reaching past the bottom is the curve's
+ * last.
+ */
+static bool setCurveSegment(Edge* edge, CurveEdge* curve, GPoint p0, GPoint p1) {
+    float bottom = curve->clipBottom;
+
+    if (p1.y() > bottom) {
+        float newX = p1.x() - (p1.x() - p0.x()) * (p1.y() - bottom) / (p1.y() - p0.y());
+        p1.set(newX, bottom);
+        curve->count = 0;
+    }
+
+    return setSegment(edge, p0, p1);
+}
+
+
+/**
+ * Move an edge on to the next segment of its curve that crosses a pixel
+ * center, if there is one.
+ */
+static bool nextSegment(Edge* edge, CurveEdge* curve) {
+    while (curve->count > 0) {
+        GPoint p0 = curve->pt;
+        if (p0.y() >= curve->clipBottom) {
+            curve->count = 0;
+            return false;
+        }
+
+        GPoint p1 = stepCurve(curve);
+        if (setCurveSegment(edge, curve, p0, p1)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+bool Edge::initCurve(
+        const GPoint pts[],
+        int count,
+        int segments,
+        GRect bounds,
+        std::vector<CurveEdge>& curves) {
+    GASSERT(count == 3 || count == 4);
+    GASSERT(segments > 0);
+    GASSERT(curves.size() < (size_t) kMaxCurveEdges);
+
+    GPoint p[4] = {};
+    std::copy(pts, pts + count, p);
+
+    // Step the curve downwards, flipping the winding if it points up.
+    this->wind = 1;
+    if (p[0].y() > p[count - 1].y()) {
+        std::reverse(p, p + count);
+        this->wind = -1;
+    }
+
+    // P(t) = At^3 + Bt^2 + Ct + D, where a quadratic simply has no A term.
+    GVector a, b, c;
+    if (count == 3) {
+        a = { 0, 0 };
+        b = (p[0] - p[1]) - (p[1] - p[2]);
+        c = 2 * (p[1] - p[0]);
+    } else {
+        a = (p[3] - p[0]) + 3 * (p[1] - p[2]);
+        b = 3 * ((p[0] - p[1]) - (p[1] - p[2]));
+        c = 3 * (p[1] - p[0]);
+    }
+
+    float h = 1.0f / segments;
+
+    CurveEdge curve;
+    curve.count = segments;
+    curve.pt = p[0];
+    curve.end = p[count - 1];
+    curve.d1 = a * (h * h * h) + b * (h * h) + c * h;
+    curve.d2 = a * (6 * h * h * h) + b * (2 * h * h);
+    curve.d3 = a * (6 * h * h * h);
+    curve.clipBottom = bounds.bottom();
+
+    // Step past the segments above the clip, then clip the top of the first
+    // one that reaches into it.
+    float top = bounds.top();
+    while (curve.count > 0) {
+        GPoint p0 = curve.pt;
+        GPoint p1 = stepCurve(&curve);
+
+        if (p1.y() <= top) {
+            continue;
+        }
+
+        if (p0.y() < top) {
+            float newX = p0.x() + (p1.x() - p0.x()) * (top - p0.y()) / (p1.y() - p0.y());
+            p0.set(newX, top);
+        }
+
+        if (!setCurveSegment(this, &curve, p0, p1) && !nextSegment(this, &curve)) {
+            return false;
+        }
+
+        this->curve = (short) curves.size();
+        curves.push_back(curve);
+
+        return true;
+    }
+
+    return false;
+}
+
 
-    if (topY == bottomY) {
+bool Edge::nextCurveSegment(CurveEdge curves[]) {
+    return this->curve >= 0 && nextSegment(this, &curves[this->curve]);
+}
+
+
+int Edge::lastY(const CurveEdge curves[]) const {
+    if (this->curve < 0 || curves[this->curve].count == 0) {
+        return this->bottomY;
+    }
+
+    const CurveEdge& curve = curves[this->curve];
+
+    return GRoundToInt(std::min(curve.end.y(), curve.clipBottom));
+}
+
+
+void CurveEdge::offset(float dx, int dy) {
+    GVector delta = { dx, (float) dy };
+
+    this->pt += delta;
+    this->end += delta;
+    this->clipBottom += dy;
+}
+
+
+void Edge::offset(float dx, int dy) {
+    this->topY += dy;
+    this->bottomY += dy;
+    this->curX += dx;
+}
+
+
+bool Edge::clipY(int top, int bottom, CurveEdge curves[]) {
+    if (this->curve >= 0) {
+        CurveEdge& curve = curves[this->curve];
+        curve.clipBottom = std::min(curve.clipBottom, (float) bottom);
+    }
+
+    while (this->bottomY <= top) {
+        if (!this->nextCurveSegment(curves)) {
+            return false;
+        }
+    }
+
+    if (this->topY >= bottom) {
         return false;
     }
 
-    this->dxdy = (p1.x() - p0.x()) / (bottomY - topY);
+    if (this->topY < top) {
+        this->curX += this->dxdy * (top - this->topY);
+        this->topY = top;
+    }
 
-    float dx = this->dxdy * (this->topY - p0.y() + 0.5f);
-    this->curX = p0.x() + dx;
+    if (this->bottomY > bottom) {
+        this->bottomY = bottom;
+        this->curve = -1;
+    }
 
     return true;
 }
 
 
-bool Edge::operator<(const Edge& other) {
+bool Edge::operator<(const Edge& other) const {
     if (this->topY < other.topY) {
         return true;
     }
@@ -43,7 +269,9 @@ bool Edge::operator<(const Edge& other) {
         return false;
     }
 
-    return this->dxdy <= other.dxdy;
+    // Equal edges must compare false both ways for std::sort, which reads
+    // past the end of the range when given a comparator that isn't strict.
+    return this->dxdy < other.dxdy;
 }
 
 
@@ -119,3 +347,103 @@ Edge* clipLine(GPoint p0, GPoint p1, GRect bounds, Edge* edge) {
     // Now that we've clipped the segment, we make an edge from what's left.
     return edge + edge->init(p0, p1, wind);
 }
+
+
+Edge* clipLineToGuardBand(GPoint p0, GPoint p1, GRect bounds, Edge* edge) {
+    GRect guardBounds = GRect::MakeLTRB(
+        bounds.left() - kGuardBand,
+        bounds.top(),
+        bounds.right() + kGuardBand,
+        bounds.bottom());
+
+    return clipLine(p0, p1, guardBounds, edge);
+}
+
+
+Edge* clipLinesToGuardBand(const GPoint points[], int count, GRect bounds, Edge* edge) {
+    const Float4 top = Float4_Splat(bounds.top());
+    const Float4 bottom = Float4_Splat(bounds.bottom());
+    const Float4 guardLeft = Float4_Splat(bounds.left() - kGuardBand);
+    const Float4 guardRight = Float4_Splat(bounds.right() + kGuardBand);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const GPoint* segment = points + 2 * i;
+
+        Float4 x0 = { segment[0].fX, segment[2].fX, segment[4].fX, segment[6].fX };
+        Float4 y0 = { segment[0].fY, segment[2].fY, segment[4].fY, segment[6].fY };
+        Float4 x1 = { segment[1].fX, segment[3].fX, segment[5].fX, segment[7].fX };
+        Float4 y1 = { segment[1].fY, segment[3].fY, segment[5].fY, segment[7].fY };
+
+        // Ensure y0 <= y1 in every lane, flipping the winding where we swap.
+        Int4 swap = y0 > y1;
+        Int4 wind = Int4_Select(swap, Int4_Splat(-1), Int4_Splat(1));
+
+        Float4 topX = Float4_Select(swap, x1, x0);
+        Float4 topY = Float4_Select(swap, y1, y0);
+        Float4 bottomX = Float4_Select(swap, x0, x1);
+        Float4 bottomY = Float4_Select(swap, y0, y1);
+
+        // Lanes that are entirely above or below the clip produce nothing.
+        Int4 visible = (bottomY > top) & (topY < bottom);
+
+        // Lanes that leave the guard band need the full clipper, so we hand
+        // them off to it after the vector pass.
+        Int4 outsideGuard = (Float4_Min(topX, bottomX) < guardLeft)
+            | (Float4_Max(topX, bottomX) > guardRight);
+
+        // Clip the top and bottom. Horizontal lanes divide by zero here, but
+        // they never cross a row, so they are never kept.
+        Float4 dxdy = (bottomX - topX) / (bottomY - topY);
+
+        Int4 clipTop = topY < top;
+        topX = Float4_Select(clipTop, topX + dxdy * (top - topY), topX);
+        topY = Float4_Select(clipTop, top, topY);
+
+        Int4 clipBottom = bottomY > bottom;
+        bottomX = Float4_Select(clipBottom, bottomX - dxdy * (bottomY - bottom), bottomX);
+        bottomY = Float4_Select(clipBottom, bottom, bottomY);
+
+        // This mirrors Edge::init
+        Int4 topRow = Float4_RoundToInt(topY);
+        Int4 bottomRow = Float4_RoundToInt(bottomY);
+
+        Float4 curX = topX + dxdy * (Int4_ToFloat(topRow) - topY + Float4_Splat(0.5f));
+
+        Int4 keep = visible & ~outsideGuard & (topRow != bottomRow);
+
+        // Compact the surviving lanes into the edge array.
+        for (int lane = 0; lane < 4; ++lane) {
+            if (keep[lane]) {
+                edge->topY = topRow[lane];
+                edge->bottomY = bottomRow[lane];
+                edge->curX = curX[lane];
+                edge->dxdy = dxdy[lane];
+                edge->wind = wind[lane];
+                edge->curve = -1;
+                edge++;
+            } else if (visible[lane] && outsideGuard[lane]) {
+                edge = clipLineToGuardBand(segment[2 * lane], segment[2 * lane + 1], bounds, edge);
+            }
+        }
+    }
+
+    // Handle whatever doesn't fill a complete vector.
+    for (; i < count; ++i) {
+        edge = clipLineToGuardBand(points[2 * i], points[2 * i + 1], bounds, edge);
+    }
+
+    return edge;
+}
+
+
+bool isInsideGuardBand(const GPoint points[], int count, GRect bounds) {
+    for (int i = 0; i < count; ++i) {
+        if (points[i].x() < bounds.left() - kGuardBand
+                || points[i].x() > bounds.right() + kGuardBand) {
+            return false;
+        }
+    }
+
+    return true;
+}
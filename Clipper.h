@@ -1,12 +1,45 @@
 #ifndef Clipper_DEFINED
 #define Clipper_DEFINED
 
-#include <deque>
+#include <vector>
 
 #include "GPoint.h"
 #include "GRect.h"
 
 
+/**
+ * The state of a y-monotonic quadratic or cubic that is stepped by forward
+ * differencing, producing its line segments one at a time as the scan
+ * converter reaches them. Curve states are kept apart from the edges, so that
+ * the far more common line edges stay small.
+ */
+struct CurveEdge {
+    int count;
+    GPoint pt;
+    GPoint end;
+    GVector d1;
+    GVector d2;
+    GVector d3;
+    float clipBottom;
+
+    /**
+     * Move the segments the curve has yet to produce.
+     *
+     * Args:
+     *     dx:
+     *         The horizontal distance to move the curve.
+     *     dy:
+     *         The number of rows to move the curve down.
+     */
+    void offset(float dx, int dy);
+};
+
+
+// The most curve edges that one array can hold, since edges refer to their
+// curves with a short index.
+static const int kMaxCurveEdges = 1 << 15;
+
+
 /**
  * An edge contains information about a line segment. It contains the minimum
  * amount of information necessary for our scan converter.
@@ -18,6 +51,11 @@ struct Edge {
     float dxdy;
     short wind;
 
+    // The index of the edge's state in the array of curve edges it was built
+    // with, or -1 for a line edge. The fields above always describe the
+    // current segment of a curve.
+    short curve;
+
     /**
      * Initialize a new edge from two points.
      *
@@ -35,11 +73,99 @@ struct Edge {
      */
     bool init(GPoint p0, GPoint p1, int wind);
 
+    /**
+     * Initialize a new curve edge from a y-monotonic quadratic or cubic curve.
+     *
+     * The curve is clipped to the top and bottom of the bounds as it is
+     * stepped, but not horizontally, so it should lie within the guard band
+     * (see 'isInsideGuardBand').
+     *
+     * Args:
+     *     pts:
+     *         The device space control points of the curve.
+     *     count:
+     *         The number of control points, 3 for a quadratic or 4 for a
+     *         cubic.
+     *     segments:
+     *         The number of line segments to step the curve in.
+     *     bounds:
+     *         The clipping bounds.
+     *     curves:
+     *         The array of curve edges to add the curve's state to. It must
+     *         hold fewer than 'kMaxCurveEdges' curves.
+     *
+     * Returns:
+     *     A boolean indicating if the curve produced a segment crossing a
+     *     pixel center inside the bounds. If it did, the edge describes the
+     *     first such segment and its state is added to 'curves'.
+     */
+    bool initCurve(
+            const GPoint pts[],
+            int count,
+            int segments,
+            GRect bounds,
+            std::vector<CurveEdge>& curves);
+
+    /**
+     * Move a curve edge on to its next segment that crosses a pixel center.
+     * Segments are contiguous, so the new segment begins on the row after the
+     * previous one ended.
+     *
+     * Args:
+     *     curves:
+     *         The array of curve edges the edge was built with.
+     *
+     * Returns:
+     *     A boolean indicating if there was another segment. This is always
+     *     false for line edges.
+     */
+    bool nextCurveSegment(CurveEdge curves[]);
+
+    /**
+     * Get the row after the last one the edge covers, including any curve
+     * segments that have not been produced yet.
+     *
+     * Args:
+     *     curves:
+     *         The array of curve edges the edge was built with.
+     */
+    int lastY(const CurveEdge curves[]) const;
+
+    /**
+     * Move the edge's current segment. The curve it belongs to, if any, is
+     * moved separately (see 'CurveEdge::offset').
+     *
+     * Args:
+     *     dx:
+     *         The horizontal distance to move the edge.
+     *     dy:
+     *         The number of rows to move the edge down.
+     */
+    void offset(float dx, int dy);
+
+    /**
+     * Clip the edge to a range of rows. Curve edges step past any segments
+     * above the range.
+     *
+     * Args:
+     *     top:
+     *         The first row to keep.
+     *     bottom:
+     *         The row after the last one to keep.
+     *     curves:
+     *         The array of curve edges the edge was built with.
+     *
+     * Returns:
+     *     A boolean indicating if any part of the edge is left.
+     */
+    bool clipY(int top, int bottom, CurveEdge curves[]);
+
     /**
      * Determine if the edge is "less than" another edge.
      *
      * Edges are compared by their upper Y value, starting X value, and then
-     * slope.
+     * slope. Edges that match in all three are equal, so neither is less
+     * than the other.
      *
      * Args:
      *     other:
@@ -48,7 +174,7 @@ struct Edge {
      * Returns:
      *     A boolean indicating if the edge is "less than" the specified edge.
      */
-    bool operator<(const Edge& other);
+    bool operator<(const Edge& other) const;
 };
 
 
@@ -75,4 +201,72 @@ struct Edge {
 Edge* clipLine(GPoint p0, GPoint p1, GRect bounds, Edge* edge);
 
 
+/**
+ * Clip the line segment described by two points to the top and bottom of a
+ * clipping region.
+ *
+ * Unlike 'clipLine', the segment is not clipped against the left and right
+ * bounds unless it extends past a generous guard band around them, so almost
+ * every segment produces exactly one edge. Edges produced this way may lie
+ * partially or entirely outside the horizontal bounds, so the blitter drawing
+ * them is responsible for clamping each span.
+ *
+ * Args:
+ *     p0:
+ *         The first point of the line segment to clip.
+ *     p1:
+ *         The second point of the line segment to clip.
+ *     bounds:
+ *         A rectangle describing the boundaries of the clipping region.
+ *     edge:
+ *         A pointer to the next available edge in an array of clipped edges.
+ *
+ * Returns:
+ *     A pointer to the next available edge in the array of clipped edges. As
+ *     with 'clipLine', this is moved forward by at most 3 edges.
+ */
+Edge* clipLineToGuardBand(GPoint p0, GPoint p1, GRect bounds, Edge* edge);
+
+
+/**
+ * Clip many line segments to the guard band at once. This produces the same
+ * edges as calling 'clipLineToGuardBand' on each segment, but processes the
+ * segments four at a time using vector instructions.
+ *
+ * Args:
+ *     points:
+ *         The segments to clip, stored as pairs of points. Segment 'i' runs
+ *         from points[2 * i] to points[2 * i + 1].
+ *     count:
+ *         The number of segments, so 'points' holds 2 * count points.
+ *     bounds:
+ *         A rectangle describing the boundaries of the clipping region.
+ *     edge:
+ *         A pointer to the next available edge in an array of clipped edges.
+ *         The array must have room for 3 * count edges.
+ *
+ * Returns:
+ *     A pointer to the next available edge in the array of clipped edges.
+ *     Only edges that survive clipping are written, and they are not
+ *     necessarily in the same order as their segments.
+ */
+Edge* clipLinesToGuardBand(const GPoint points[], int count, GRect bounds, Edge* edge);
+
+
+/**
+ * Determine if a set of points lies within the guard band around the clipping
+ * bounds, meaning that anything inside their convex hull can be drawn without
+ * clipping it horizontally.
+ *
+ * Args:
+ *     points:
+ *         The points to check.
+ *     count:
+ *         The number of points.
+ *     bounds:
+ *         A rectangle describing the boundaries of the clipping region.
+ */
+bool isInsideGuardBand(const GPoint points[], int count, GRect bounds);
+
+
 #endif
@@ -0,0 +1,534 @@
+#include <math.h>
+#include <algorithm>
+
+#include "GMath.h"
+#include "GMatrix.h"
+#include "GPath.h"
+#include "GPoint.h"
+#include "GRect.h"
+
+#include "Clipper.h"
+#include "EdgeBuilder.h"
+
+
+// No curve is ever split into more segments than this, no matter how large it
+// is on screen.
+static const int kMaxCurveSegments = 1 << 10;
+
+
+/**
+ * Determine how many line segments a quadratic curve needs so that no point
+ * on the curve is further than the tolerance from the segments.
+ *
+ * The distance between a quadratic and its chord is a quarter of the length
+ * of p0 - 2p1 + p2, and splitting the curve into n pieces shrinks that
+ * distance by n^2.
+ */
+int countQuadSegments(const GPoint pts[3], float tolerance) {
+    GVector dd = (pts[0] - pts[1]) - (pts[1] - pts[2]);
+    float deviation = dd.length() / 4;
+
+    int count = (int) ceilf(sqrtf(deviation / tolerance));
+
+    return std::max(1, std::min(kMaxCurveSegments, count));
+}
+
+
+/**
+ * Determine how many line segments a cubic curve needs so that no point on
+ * the curve is further than the tolerance from the segments.
+ *
+ * The second derivative of a cubic is bounded by 6 times the largest second
+ * difference of its control points, and the distance between a curve and its
+ * chord is at most an eighth of that bound.
+ */
+int countCubicSegments(const GPoint pts[4], float tolerance) {
+    GVector dd0 = (pts[0] - pts[1]) - (pts[1] - pts[2]);
+    GVector dd1 = (pts[1] - pts[2]) - (pts[2] - pts[3]);
+    float deviation = 6 * std::max(dd0.length(), dd1.length()) / 8;
+
+    int count = (int) ceilf(sqrtf(deviation / tolerance));
+
+    return std::max(1, std::min(kMaxCurveSegments, count));
+}
+
+
+/**
+ * Add a segment to the list of segments, stored as pairs of points.
+ */
+static void addSegment(std::vector<GPoint>& segments, GPoint p0, GPoint p1) {
+    segments.push_back(p0);
+    segments.push_back(p1);
+}
+
+
+/**
+ * Flatten a quadratic curve into line segments by forward differencing.
+ *
+ * Args:
+ *     pts:
+ *         The device space control points of the curve.
+ *     tolerance:
+ *         The maximum distance between the curve and the segments.
+ *     segments:
+ *         The list of segments to add to.
+ */
+static void flattenQuad(const GPoint pts[3], float tolerance, std::vector<GPoint>& segments) {
+    int count = countQuadSegments(pts, tolerance);
+    float h = 1.0f / count;
+
+    // P(t) = At^2 + Bt + C
+    GVector a = (pts[0] - pts[1]) - (pts[1] - pts[2]);
+    GVector b = 2 * (pts[1] - pts[0]);
+
+    GVector d1 = a * (h * h) + b * h;
+    GVector d2 = a * (2 * h * h);
+
+    GPoint prev = pts[0];
+    GPoint curr = pts[0];
+    for (int i = 1; i < count; ++i) {
+        curr += d1;
+        d1 = d1 + d2;
+
+        addSegment(segments, prev, curr);
+        prev = curr;
+    }
+
+    // End exactly on the last control point so contours stay closed.
+    addSegment(segments, prev, pts[2]);
+}
+
+
+/**
+ * Flatten a cubic curve into line segments by forward differencing.
+ *
+ * Args:
+ *     pts:
+ *         The device space control points of the curve.
+ *     tolerance:
+ *         The maximum distance between the curve and the segments.
+ *     segments:
+ *         The list of segments to add to.
+ */
+static void flattenCubic(const GPoint pts[4], float tolerance, std::vector<GPoint>& segments) {
+    int count = countCubicSegments(pts, tolerance);
+    float h = 1.0f / count;
+
+    // P(t) = At^3 + Bt^2 + Ct + D
+    GVector a = (pts[3] - pts[0]) + 3 * (pts[1] - pts[2]);
+    GVector b = 3 * ((pts[0] - pts[1]) - (pts[1] - pts[2]));
+    GVector c = 3 * (pts[1] - pts[0]);
+
+    GVector d1 = a * (h * h * h) + b * (h * h) + c * h;
+    GVector d2 = a * (6 * h * h * h) + b * (2 * h * h);
+    GVector d3 = a * (6 * h * h * h);
+
+    GPoint prev = pts[0];
+    GPoint curr = pts[0];
+    for (int i = 1; i < count; ++i) {
+        curr += d1;
+        d1 = d1 + d2;
+        d2 = d2 + d3;
+
+        addSegment(segments, prev, curr);
+        prev = curr;
+    }
+
+    addSegment(segments, prev, pts[3]);
+}
+
+
+/**
+ * Determine if a curve lies entirely above or below the clipping bounds. Such
+ * a curve can't produce any edges, so there is no reason to flatten it.
+ *
+ * Args:
+ *     pts:
+ *         The device space control points of the curve.
+ *     count:
+ *         The number of control points.
+ *     bounds:
+ *         The clipping bounds.
+ */
+static bool isCurveOutsideY(const GPoint pts[], int count, const GRect& bounds) {
+    bool above = true;
+    bool below = true;
+    for (int i = 0; i < count; ++i) {
+        above &= pts[i].fY <= bounds.top();
+        below &= pts[i].fY >= bounds.bottom();
+    }
+
+    return above || below;
+}
+
+
+/**
+ * Get the sign of a number as -1, 0, or 1.
+ */
+static int sign(float x) {
+    return (x > 0) - (x < 0);
+}
+
+
+/**
+ * Get the z-component of the cross product of two vectors, which is positive
+ * when 'b' is counter-clockwise from 'a'.
+ */
+static float cross(GVector a, GVector b) {
+    return a.x() * b.y() - a.y() * b.x();
+}
+
+
+/**
+ * Merges runs of consecutive line segments into single segments before they
+ * are clipped, so that a path with far more segments than pixels produces a
+ * number of edges proportional to its size on screen.
+ *
+ * A run is merged when either:
+ *     - Every point in it rounds to the same row. Such a run can't cross a
+ *       pixel center, so it produces no edges either way and merging it is
+ *       exact.
+ *     - It is monotonic in y and every point in it lies within the tolerance
+ *       of the merged segment. Monotonic runs cross each row at most once, in
+ *       the same direction as the merged segment, so winding is preserved.
+ *
+ * The tolerance test is done incrementally by narrowing a wedge of directions
+ * from the start of the run: each point farther than the tolerance from the
+ * start only allows merged segments whose direction passes within the
+ * tolerance of it.
+ */
+class SegmentDecimator {
+public:
+    SegmentDecimator(float tolerance, std::vector<GPoint>& segments)
+        : fTolerance(tolerance)
+        , fSegments(segments)
+        , fActive(false)
+        , fStart({0, 0})
+        , fEnd({0, 0})
+        , fRow(0)
+        , fSameRow(false)
+        , fWithinTolerance(false)
+        , fHasWedge(false)
+        , fLeft({0, 0})
+        , fRight({0, 0})
+        , fDirY(0)
+        , fMaxDist2(0) {}
+
+    /**
+     * Add the line segment from p0 to p1. Segments that don't continue from
+     * the end of the current run start a new one.
+     */
+    void addLine(GPoint p0, GPoint p1) {
+        if (!this->fActive || p0 != this->fEnd) {
+            this->flush();
+            this->start(p0);
+        }
+
+        if (!this->extend(p1)) {
+            GPoint end = this->fEnd;
+            this->flush();
+            this->start(end);
+            this->extend(p1);
+        }
+    }
+
+    /**
+     * Emit the current run as a single segment.
+     */
+    void flush() {
+        if (this->fActive && this->fEnd != this->fStart) {
+            addSegment(this->fSegments, this->fStart, this->fEnd);
+        }
+
+        this->fActive = false;
+    }
+
+private:
+    void start(GPoint p) {
+        this->fStart = p;
+        this->fEnd = p;
+        this->fActive = true;
+        this->fRow = GRoundToInt(p.y());
+        this->fSameRow = true;
+        this->fWithinTolerance = true;
+        this->fHasWedge = false;
+        this->fDirY = 0;
+        this->fMaxDist2 = 0;
+    }
+
+    /**
+     * Try to add a point to the end of the current run.
+     *
+     * Returns:
+     *     A boolean indicating if the point was added.
+     */
+    bool extend(GPoint p) {
+        bool sameRow = this->fSameRow && GRoundToInt(p.y()) == this->fRow;
+        bool withinTolerance = this->fWithinTolerance && this->fitsWedge(p);
+
+        if (!sameRow && !withinTolerance) {
+            return false;
+        }
+
+        if (withinTolerance) {
+            this->narrowWedge(p);
+        }
+
+        this->fSameRow = sameRow;
+        this->fWithinTolerance = withinTolerance;
+        this->fEnd = p;
+
+        return true;
+    }
+
+    /**
+     * Determine if the run could be merged into a single segment ending at p.
+     */
+    bool fitsWedge(GPoint p) const {
+        int dy = sign(p.y() - this->fEnd.y());
+        if (dy != 0 && this->fDirY != 0 && dy != this->fDirY) {
+            return false;
+        }
+
+        // Each point must be at least as far from the start as the last, so
+        // that none of them lie past the end of the merged segment.
+        GVector v = p - this->fStart;
+        if (v.x() * v.x() + v.y() * v.y() < this->fMaxDist2) {
+            return false;
+        }
+
+        return !this->fHasWedge || (cross(this->fRight, v) >= 0 && cross(v, this->fLeft) >= 0);
+    }
+
+    /**
+     * Limit the directions of future merged segments to those passing within
+     * the tolerance of p.
+     */
+    void narrowWedge(GPoint p) {
+        if (this->fDirY == 0) {
+            this->fDirY = sign(p.y() - this->fEnd.y());
+        }
+
+        GVector v = p - this->fStart;
+        this->fMaxDist2 = v.x() * v.x() + v.y() * v.y();
+
+        float dist = sqrtf(this->fMaxDist2);
+        if (dist <= this->fTolerance) {
+            return;
+        }
+
+        // Rotate v both ways by the angle whose sine is tolerance / dist.
+        float sinAngle = this->fTolerance / dist;
+        float cosAngle = sqrtf(1 - sinAngle * sinAngle);
+
+        GVector left = {
+            v.x() * cosAngle - v.y() * sinAngle,
+            v.x() * sinAngle + v.y() * cosAngle
+        };
+        GVector right = {
+            v.x() * cosAngle + v.y() * sinAngle,
+            v.y() * cosAngle - v.x() * sinAngle
+        };
+
+        if (!this->fHasWedge) {
+            this->fLeft = left;
+            this->fRight = right;
+            this->fHasWedge = true;
+            return;
+        }
+
+        if (cross(this->fRight, right) > 0) {
+            this->fRight = right;
+        }
+        if (cross(left, this->fLeft) > 0) {
+            this->fLeft = left;
+        }
+    }
+
+    const float fTolerance;
+    std::vector<GPoint>& fSegments;
+
+    bool fActive;
+    GPoint fStart;
+    GPoint fEnd;
+
+    int fRow;
+    bool fSameRow;
+
+    bool fWithinTolerance;
+    bool fHasWedge;
+    GVector fLeft;
+    GVector fRight;
+    int fDirY;
+    float fMaxDist2;
+};
+
+
+/**
+ * Add a y-monotonic curve to the path's edges. Curves within the guard band
+ * become a single curve edge that the scan converter steps lazily, so no
+ * segments are produced for rows that are never reached. Anything else, or a
+ * curve flat enough to be a single line, goes to the list of segments.
+ *
+ * Args:
+ *     pts:
+ *         The device space control points of the curve.
+ *     count:
+ *         The number of control points, 3 for a quadratic or 4 for a cubic.
+ *     tolerance:
+ *         The maximum distance between the curve and its segments.
+ *     bounds:
+ *         The clipping bounds.
+ *     segments:
+ *         The list of line segments to add to.
+ *     curveEdges:
+ *         The list of curve edges to add to.
+ *     curves:
+ *         The list of curve states that the curve edges index into.
+ */
+static void addCurve(
+        const GPoint pts[],
+        int count,
+        float tolerance,
+        const GRect& bounds,
+        std::vector<GPoint>& segments,
+        std::vector<Edge>& curveEdges,
+        std::vector<CurveEdge>& curves) {
+    if (isCurveOutsideY(pts, count, bounds)) {
+        return;
+    }
+
+    // Curves that can't be indexed by an edge are flattened like those that
+    // leave the guard band.
+    if (!isInsideGuardBand(pts, count, bounds) || curves.size() >= (size_t) kMaxCurveEdges) {
+        if (count == 3) {
+            flattenQuad(pts, tolerance, segments);
+        } else {
+            flattenCubic(pts, tolerance, segments);
+        }
+
+        return;
+    }
+
+    int segmentCount = count == 3
+        ? countQuadSegments(pts, tolerance)
+        : countCubicSegments(pts, tolerance);
+
+    if (segmentCount == 1) {
+        addSegment(segments, pts[0], pts[count - 1]);
+        return;
+    }
+
+    Edge edge;
+    if (edge.initCurve(pts, count, segmentCount, bounds, curves)) {
+        curveEdges.push_back(edge);
+    }
+}
+
+
+void flattenCurve(const GPoint pts[], int count, float tolerance, std::vector<GPoint>& dst) {
+    int segmentCount = count == 3
+        ? countQuadSegments(pts, tolerance)
+        : countCubicSegments(pts, tolerance);
+
+    float ts[kMaxCurveSegments];
+    for (int i = 0; i < segmentCount; ++i) {
+        ts[i] = (float) (i + 1) / segmentCount;
+    }
+
+    size_t start = dst.size();
+    dst.resize(start + segmentCount);
+
+    if (count == 3) {
+        GPath::EvalQuadAt(pts, ts, &dst[start], segmentCount);
+    } else {
+        GPath::EvalCubicAt(pts, ts, &dst[start], segmentCount);
+    }
+
+    // Land exactly on the end point, so that closed contours stay closed.
+    dst.back() = pts[count - 1];
+}
+
+
+PathEdges buildPathEdges(
+        const GPath& path,
+        const GMatrix& ctm,
+        const GRect& bounds,
+        float tolerance,
+        float decimateTolerance) {
+    // Each line produces one segment, as does the edge closing each contour.
+    // Curves are split into at most 2 (quads) or 3 (cubics) monotonic pieces,
+    // which only become segments when they are too flat to be worth stepping
+    // or leave the guard band, and then only as many as the tolerance needs.
+    int lineCount = path.countVerbs(GPath::kLine) + path.countVerbs(GPath::kMove);
+    int pieceCount = 2 * path.countVerbs(GPath::kQuad) + 3 * path.countVerbs(GPath::kCubic);
+
+    std::vector<GPoint> segments;
+    segments.reserve(2 * (lineCount + pieceCount));
+
+    std::vector<Edge> curveEdges;
+    curveEdges.reserve(pieceCount);
+
+    PathEdges result;
+    result.curves.reserve(pieceCount);
+
+    SegmentDecimator decimator(decimateTolerance, segments);
+
+    GPath::Edger edger = GPath::Edger(path);
+
+    GPath::Verb verb;
+    do {
+        GPoint nextPts[4];
+        verb = edger.next(nextPts);
+
+        // Curves are split into segments after they are mapped, so the
+        // number of segments matches their size on screen.
+        if (verb == GPath::Verb::kLine) {
+            ctm.mapPoints(nextPts, nextPts, 2);
+
+            if (decimateTolerance > 0) {
+                decimator.addLine(nextPts[0], nextPts[1]);
+            } else {
+                addSegment(segments, nextPts[0], nextPts[1]);
+            }
+
+            continue;
+        }
+
+        // A curve ends any run of lines being merged.
+        decimator.flush();
+
+        if (verb == GPath::Verb::kQuad) {
+            ctm.mapPoints(nextPts, nextPts, 3);
+
+            // Monotonic pieces that miss the clip vertically are skipped.
+            GPoint pieces[5];
+            int pieceCount = GPath::ChopQuadAtYExtrema(nextPts, pieces);
+            for (int i = 0; i < pieceCount; ++i) {
+                addCurve(pieces + 2 * i, 3, tolerance, bounds,
+                         segments, curveEdges, result.curves);
+            }
+        } else if (verb == GPath::Verb::kCubic) {
+            ctm.mapPoints(nextPts, nextPts, 4);
+
+            GPoint pieces[10];
+            int pieceCount = GPath::ChopCubicAtYExtrema(nextPts, pieces);
+            for (int i = 0; i < pieceCount; ++i) {
+                addCurve(pieces + 3 * i, 4, tolerance, bounds,
+                         segments, curveEdges, result.curves);
+            }
+        }
+    } while (verb != GPath::Verb::kDone);
+
+    int segmentCount = segments.size() / 2;
+
+    std::vector<Edge>& edges = result.edges;
+    edges.resize(3 * segmentCount + curveEdges.size());
+    Edge* edge = clipLinesToGuardBand(segments.data(), segmentCount, bounds, edges.data());
+    edge = std::copy(curveEdges.begin(), curveEdges.end(), edge);
+
+    // Trim the storage down to the edges that survived clipping
+    edges.resize(edge - edges.data());
+
+    return result;
+}
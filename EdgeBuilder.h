@@ -0,0 +1,102 @@
+#ifndef EdgeBuilder_DEFINED
+#define EdgeBuilder_DEFINED
+
+#include <vector>
+
+#include "GMatrix.h"
+#include "GPath.h"
+#include "GPoint.h"
+#include "GRect.h"
+
+#include "Clipper.h"
+
+
+// The default maximum distance, in pixels, between a curve and the line
+// segments it is flattened into.
+static const float kDefaultFlattenTolerance = 0.25f;
+
+// The default maximum distance, in pixels, between a run of line segments and
+// the single segment it is merged into when decimating.
+static const float kDefaultDecimateTolerance = 0.25f;
+
+
+/**
+ * The edges of a path, along with the state of its curve edges. Line edges
+ * have no curve state, so the curves are kept in their own array, which the
+ * curve edges index into.
+ */
+struct PathEdges {
+    std::vector<Edge> edges;
+    std::vector<CurveEdge> curves;
+};
+
+
+/**
+ * Determine how many line segments a quadratic curve must be flattened into so
+ * that no point on the curve is further than the tolerance from them.
+ */
+int countQuadSegments(const GPoint pts[3], float tolerance);
+
+/**
+ * Determine how many line segments a cubic curve must be flattened into so
+ * that no point on the curve is further than the tolerance from them.
+ */
+int countCubicSegments(const GPoint pts[4], float tolerance);
+
+/**
+ * Flatten a curve into a polyline, appending its points after the first to a
+ * list of points. The last point appended is exactly the curve's end point.
+ *
+ * Args:
+ *     pts:
+ *         The control points of the curve.
+ *     count:
+ *         The number of control points: 3 for a quadratic, 4 for a cubic.
+ *     tolerance:
+ *         The maximum distance between the curve and the polyline.
+ *     dst:
+ *         The list of points to append to.
+ */
+void flattenCurve(const GPoint pts[], int count, float tolerance, std::vector<GPoint>& dst);
+
+
+/**
+ * Convert a path into the set of clipped edges used by the scan converter.
+ * Curves are split into y-monotonic pieces in device space, and each piece
+ * becomes a curve edge that the scan converter steps through lazily, using as
+ * few segments as the tolerance allows.
+ *
+ * Args:
+ *     path:
+ *         The path to build edges for.
+ *     ctm:
+ *         The matrix used to map the path's points into device space.
+ *     bounds:
+ *         The device space rectangle to clip the edges to. Edges are only
+ *         clipped vertically, so the horizontal bounds must also be enforced
+ *         by the blitter.
+ *     tolerance:
+ *         The maximum distance in device space between a curve and the line
+ *         segments approximating it.
+ *     decimateTolerance:
+ *         If positive, runs of consecutive line segments are merged into
+ *         single segments wherever that moves no point of the run by more
+ *         than this distance in device space, or where the run stays within
+ *         one row. Merging never changes which way a run winds, and it keeps
+ *         the number of edges in proportion to the path's size on screen
+ *         rather than its number of points.
+ *
+ * Returns:
+ *     The clipped edges of the path, in no particular order, and the curves
+ *     they step through. Curves are advanced as their edges are scanned, so
+ *     the edges can only be drawn once.
+ */
+PathEdges buildPathEdges(
+        const GPath& path,
+        const GMatrix& ctm,
+        const GRect& bounds,
+        float tolerance = kDefaultFlattenTolerance,
+        float decimateTolerance = 0);
+
+
+#endif
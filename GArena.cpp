@@ -0,0 +1,68 @@
+#include <algorithm>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "GArena.h"
+#include "GTypes.h"
+
+
+GArena::GArena(size_t blockSize)
+    : fBlockSize(blockSize)
+    , fCurrBlock(0)
+    , fUsed(0) {}
+
+
+GArena::~GArena() {
+    for (Block& block : this->fBlocks) {
+        free(block.fData);
+    }
+}
+
+
+void* GArena::alloc(size_t size, size_t align) {
+    GASSERT((align & (align - 1)) == 0);
+
+    // Try the current block, then any later blocks left over from before the
+    // last reset.
+    while (this->fCurrBlock < this->fBlocks.size()) {
+        Block& block = this->fBlocks[this->fCurrBlock];
+
+        uintptr_t addr = reinterpret_cast<uintptr_t>(block.fData) + this->fUsed;
+        size_t padding = (align - (addr & (align - 1))) & (align - 1);
+
+        if (this->fUsed + padding + size <= block.fSize) {
+            this->fUsed += padding + size;
+            return block.fData + this->fUsed - size;
+        }
+
+        this->fCurrBlock++;
+        this->fUsed = 0;
+    }
+
+    // Blocks grow with the arena so that the number of blocks stays
+    // logarithmic in the amount of memory used.
+    size_t blockSize = std::max(size + align, std::max(this->fBlockSize, this->capacity()));
+
+    Block block = { static_cast<char*>(malloc(blockSize)), blockSize };
+    this->fBlocks.push_back(block);
+    this->fCurrBlock = this->fBlocks.size() - 1;
+    this->fUsed = 0;
+
+    return this->alloc(size, align);
+}
+
+
+void GArena::reset() {
+    this->fCurrBlock = 0;
+    this->fUsed = 0;
+}
+
+
+size_t GArena::capacity() const {
+    size_t total = 0;
+    for (const Block& block : this->fBlocks) {
+        total += block.fSize;
+    }
+
+    return total;
+}
@@ -1,20 +1,56 @@
+#include <algorithm>
+
 #include "GBlitter.h"
 #include "GFilter.h"
 #include "GPaint.h"
 #include "GPixel.h"
+#include "GRegion.h"
 #include "GShader.h"
 
 #include "Blend.h"
 #include "ColorUtils.h"
 
 
-void GBlitter::blitRow(int y, int xLeft, int xRight) {
+void GPaintBlitter::blitRow(int y, int xLeft, int xRight) {
     GASSERT(xLeft <= xRight);
     xLeft = std::max(0, xLeft);
     xRight = std::min(this->fBitmap.width(), xRight);
 
+    // Edges are only clipped vertically, so the span may lie entirely outside
+    // of the bitmap.
+    if (xLeft >= xRight) {
+        return;
+    }
+
+    if (this->fRegion == nullptr) {
+        this->blitSpan(y, xLeft, xRight);
+        return;
+    }
+
+    int count;
+    const GRegion::Span* spans = this->fRegion->getRow(y, &count);
+
+    // Skip straight to the first span that could overlap the row.
+    const GRegion::Span* span = std::upper_bound(
+        spans,
+        spans + count,
+        xLeft,
+        [](int x, const GRegion::Span& span) { return x < span.fRight; });
+
+    for (; span < spans + count && span->fLeft < xRight; ++span) {
+        this->blitSpan(y, std::max(xLeft, span->fLeft), std::min(xRight, span->fRight));
+    }
+}
+
+
+void GPaintBlitter::blitSpan(int y, int xLeft, int xRight) {
     BlendProc blendProc = Blend_GetProc(this->fPaint.getBlendMode());
 
+    const uint8_t* coverage = nullptr;
+    if (this->fMask != nullptr) {
+        coverage = this->fMask->getAddr(0, y);
+    }
+
     GShader* shader = this->fPaint.getShader();
     if (shader == nullptr) {
         GColor color = this->fPaint.getColor().pinToUnit();
@@ -26,7 +62,12 @@ void GBlitter::blitRow(int y, int xLeft, int xRight) {
 
         for (int x = xLeft; x < xRight; ++x) {
             GPixel* addr = this->fBitmap.getAddr(x, y);
-            *addr = blendProc(source[0], *addr);
+
+            if (coverage == nullptr) {
+                *addr = blendProc(source[0], *addr);
+            } else if (coverage[x] != 0) {
+                *addr = Blend_Lerp(*addr, blendProc(source[0], *addr), coverage[x]);
+            }
         }
     } else {
         int count = xRight - xLeft;
@@ -39,7 +80,12 @@ void GBlitter::blitRow(int y, int xLeft, int xRight) {
 
         for (int x = xLeft; x < xRight; ++x) {
             GPixel* addr = this->fBitmap.getAddr(x, y);
-            *addr = blendProc(shaded[x - xLeft], *addr);
+
+            if (coverage == nullptr) {
+                *addr = blendProc(shaded[x - xLeft], *addr);
+            } else if (coverage[x] != 0) {
+                *addr = Blend_Lerp(*addr, blendProc(shaded[x - xLeft], *addr), coverage[x]);
+            }
         }
 
         free(shaded);
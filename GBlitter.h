@@ -3,25 +3,21 @@
 
 #include "GBitmap.h"
 #include "GPaint.h"
+#include "GRegion.h"
 
+#include "GClipMask.h"
 
+
+/**
+ * A blitter is the destination for the rows produced by the scan converter.
+ * Subclasses decide what "drawing" a row actually means.
+ */
 class GBlitter {
 public:
-    /**
-     * Construct a new blitter that draws to the provided bitmap.
-     *
-     * Args:
-     *     bitmap:
-     *         The bitmap that gets drawn to.
-     *     paint:
-     *         The paint used by the blitter.
-     */
-    GBlitter(const GBitmap& bitmap, const GPaint& paint)
-        : fBitmap(bitmap)
-        , fPaint(paint) {}
+    virtual ~GBlitter() {}
 
     /**
-     * Draw a row to the blitter's bitmap.
+     * Draw a row of pixels.
      *
      * Args:
      *     y:
@@ -30,14 +26,53 @@ public:
      *         The x-coordinate of the beginning of the row.
      *     xRight:
      *         The x-coordinate of the end of the row.
+     */
+    virtual void blitRow(int y, int xLeft, int xRight) = 0;
+};
+
+
+/**
+ * Blitter that fills rows of a bitmap using a paint.
+ */
+class GPaintBlitter : public GBlitter {
+public:
+    /**
+     * Construct a new blitter that draws to the provided bitmap.
+     *
+     * Args:
+     *     bitmap:
+     *         The bitmap that gets drawn to.
      *     paint:
-     *         The paint to draw the row with.
+     *         The paint used by the blitter.
+     *     mask:
+     *         An optional coverage mask the size of the bitmap. If provided,
+     *         each pixel drawn is scaled by its coverage in the mask.
+     *     region:
+     *         An optional region to clip each row to.
      */
-    void blitRow(int y, int xLeft, int xRight);
+    GPaintBlitter(
+            const GBitmap& bitmap,
+            const GPaint& paint,
+            const GClipMask* mask = nullptr,
+            const GRegion* region = nullptr)
+        : fBitmap(bitmap)
+        , fPaint(paint)
+        , fMask(mask)
+        , fRegion(region) {}
+
+    void blitRow(int y, int xLeft, int xRight) override;
 
 private:
+    /**
+     * Draw a span of pixels that has already been clipped to the bitmap and
+     * clip region.
+     */
+    void blitSpan(int y, int xLeft, int xRight);
+
     const GBitmap fBitmap;
     const GPaint fPaint;
+    const GClipMask* fMask;
+    const GRegion* fRegion;
 };
 
 
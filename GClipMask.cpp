@@ -0,0 +1,139 @@
+#include "GBlitter.h"
+#include "GMatrix.h"
+#include "GPath.h"
+#include "GRect.h"
+
+#include "EdgeBuilder.h"
+#include "GClipMask.h"
+#include "GScanConverter.h"
+
+
+// Paths are rasterized at 4x resolution in each direction, so every pixel of
+// the mask is made up of 16 samples.
+static const int kSupersampleShift = 2;
+static const int kSupersample = 1 << kSupersampleShift;
+static const int kSampleCoverage = 256 / (kSupersample * kSupersample);
+
+
+/**
+ * Blitter that accumulates supersampled rows into a coverage mask.
+ */
+class GMaskBlitter : public GBlitter {
+public:
+    GMaskBlitter(uint8_t* coverage, int width)
+        : fCoverage(coverage)
+        , fWidth(width) {}
+
+    void blitRow(int y, int xLeft, int xRight) override {
+        xLeft = std::max(0, xLeft);
+        xRight = std::min(fWidth << kSupersampleShift, xRight);
+
+        uint8_t* row = fCoverage + (y >> kSupersampleShift) * fWidth;
+
+        int x = xLeft;
+        while (x < xRight) {
+            int pixel = x >> kSupersampleShift;
+            int end = std::min(xRight, (pixel + 1) << kSupersampleShift);
+
+            row[pixel] = std::min(255, row[pixel] + (end - x) * kSampleCoverage);
+            x = end;
+        }
+    }
+
+private:
+    uint8_t* fCoverage;
+    int fWidth;
+};
+
+
+GClipMask::GClipMask(int width, int height)
+        : fWidth(width)
+        , fHeight(height)
+        , fCoverage(width * height, 255) {
+    this->fBounds = GIRect::MakeWH(width, height);
+}
+
+
+GClipMask::GClipMask(const GPath& path, const GMatrix& ctm, int width, int height)
+        : fWidth(width)
+        , fHeight(height)
+        , fCoverage(width * height, 0) {
+    GMatrix superCTM = ctm;
+    superCTM.postScale(kSupersample, kSupersample);
+
+    GRect superBounds = GRect::MakeWH(width * kSupersample, height * kSupersample);
+    PathEdges built = buildPathEdges(path, superCTM, superBounds);
+    std::vector<Edge>& edges = built.edges;
+
+    if (edges.size() >= 2) {
+        GMaskBlitter blitter = GMaskBlitter(this->fCoverage.data(), width);
+        GScanConverter::scanComplex(edges.data(), edges.size(), built.curves.data(), blitter);
+    }
+
+    this->computeBounds();
+}
+
+
+void GClipMask::intersect(const GClipMask& other) {
+    GASSERT(this->fWidth == other.fWidth && this->fHeight == other.fHeight);
+
+    for (size_t i = 0; i < this->fCoverage.size(); ++i) {
+        this->fCoverage[i] = (this->fCoverage[i] * other.fCoverage[i] + 127) / 255;
+    }
+
+    this->computeBounds();
+}
+
+
+void GClipMask::invert() {
+    for (size_t i = 0; i < this->fCoverage.size(); ++i) {
+        this->fCoverage[i] = 255 - this->fCoverage[i];
+    }
+
+    this->computeBounds();
+}
+
+
+void GClipMask::copyFrom(const GClipMask& src, int dx, int dy) {
+    for (int y = 0; y < this->fHeight; ++y) {
+        for (int x = 0; x < this->fWidth; ++x) {
+            int srcX = x - dx;
+            int srcY = y - dy;
+
+            if (srcX >= 0 && srcX < src.fWidth && srcY >= 0 && srcY < src.fHeight) {
+                this->fCoverage[y * this->fWidth + x] = *src.getAddr(srcX, srcY);
+            } else {
+                this->fCoverage[y * this->fWidth + x] = 0;
+            }
+        }
+    }
+
+    this->computeBounds();
+}
+
+
+void GClipMask::computeBounds() {
+    int left = this->fWidth;
+    int top = this->fHeight;
+    int right = 0;
+    int bottom = 0;
+
+    for (int y = 0; y < this->fHeight; ++y) {
+        const uint8_t* row = this->fCoverage.data() + y * this->fWidth;
+
+        for (int x = 0; x < this->fWidth; ++x) {
+            if (row[x] != 0) {
+                left = std::min(left, x);
+                right = std::max(right, x + 1);
+                top = std::min(top, y);
+                bottom = y + 1;
+            }
+        }
+    }
+
+    if (left >= right) {
+        this->fBounds = GIRect::MakeWH(0, 0);
+    } else {
+        this->fBounds = GIRect::MakeLTRB(left, top, right, bottom);
+    }
+}
@@ -0,0 +1,96 @@
+#ifndef GClipMask_DEFINED
+#define GClipMask_DEFINED
+
+#include <vector>
+
+#include "GMatrix.h"
+#include "GPath.h"
+#include "GRect.h"
+
+
+/**
+ * An 8-bit coverage mask used to clip drawing to an arbitrary path. Each
+ * value in the mask is the fraction of its pixel, in the range [0, 255], that
+ * lies inside the clip.
+ */
+class GClipMask {
+public:
+    /**
+     * Create a mask where every pixel is fully covered.
+     *
+     * Args:
+     *     width:
+     *         The width of the mask in pixels.
+     *     height:
+     *         The height of the mask in pixels.
+     */
+    GClipMask(int width, int height);
+
+    /**
+     * Create a mask by rasterizing a path. Coverage is computed by sampling
+     * each pixel on a 4x4 grid, so the edges of the clip are anti-aliased.
+     *
+     * Args:
+     *     path:
+     *         The path describing the clip region.
+     *     ctm:
+     *         The matrix mapping the path into device space.
+     *     width:
+     *         The width of the mask in pixels.
+     *     height:
+     *         The height of the mask in pixels.
+     */
+    GClipMask(const GPath& path, const GMatrix& ctm, int width, int height);
+
+    int width() const { return fWidth; }
+    int height() const { return fHeight; }
+
+    /**
+     * Get the smallest rectangle containing every pixel with non-zero
+     * coverage.
+     */
+    GIRect getBounds() const { return fBounds; }
+
+    const uint8_t* getAddr(int x, int y) const {
+        GASSERT(x >= 0 && x < fWidth);
+        GASSERT(y >= 0 && y < fHeight);
+        return fCoverage.data() + y * fWidth + x;
+    }
+
+    /**
+     * Intersect the mask with another mask of the same size by multiplying
+     * their coverage values.
+     */
+    void intersect(const GClipMask& other);
+
+    /**
+     * Invert the coverage of every pixel, so the mask covers everything
+     * outside of its previous contents.
+     */
+    void invert();
+
+    /**
+     * Copy the coverage of another mask into this one, offset by the given
+     * amount. Pixels not covered by the source mask are cleared.
+     *
+     * Args:
+     *     src:
+     *         The mask to copy from.
+     *     dx:
+     *         The horizontal offset applied to the source mask.
+     *     dy:
+     *         The vertical offset applied to the source mask.
+     */
+    void copyFrom(const GClipMask& src, int dx, int dy);
+
+private:
+    void computeBounds();
+
+    int fWidth;
+    int fHeight;
+    GIRect fBounds;
+    std::vector<uint8_t> fCoverage;
+};
+
+
+#endif
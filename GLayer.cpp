@@ -1,4 +1,5 @@
-#include <stdlib.h>
+#include <algorithm>
+#include <vector>
 
 #include "GFilter.h"
 #include "GLayer.h"
@@ -31,29 +32,63 @@ GLayer::GLayer(GBitmap& bitmap, GMatrix matrix, GIRect bounds, GPaint paint) {
 }
 
 
-void GLayer::draw(GBitmap* base) {
+/**
+ * Blend a span of layer pixels onto the base, scaling each by its coverage in
+ * the base's clip mask if there is one.
+ */
+static void blendSpan(
+        const GPixel src[],
+        GPixel dst[],
+        const uint8_t coverage[],
+        int count,
+        BlendProc blendProc) {
+    for (int x = 0; x < count; ++x) {
+        if (coverage == nullptr) {
+            dst[x] = blendProc(src[x], dst[x]);
+        } else if (coverage[x] != 0) {
+            dst[x] = Blend_Lerp(dst[x], blendProc(src[x], dst[x]), coverage[x]);
+        }
+    }
+}
+
+
+void GLayer::draw(GBitmap* base, const GClipMask* mask, const GRegion* region) {
     GIRect bounds = this->fBounds;
     int xOffset = bounds.left();
     int yOffset = bounds.top();
+    int width = this->fBitmap.width();
 
     BlendProc blendProc = Blend_GetProc(this->fPaint.getBlendMode());
     GFilter* filter = this->fPaint.getFilter();
+    std::vector<GPixel> filtered(filter != nullptr ? width : 0);
 
     for (int y = 0; y < this->fBitmap.height(); ++y) {
-        int width = this->fBitmap.width();
-        GPixel* row = (GPixel*) malloc(width * sizeof(GPixel));
-
-        if (filter == nullptr) {
-            row = this->fBitmap.getAddr(0, y);
-        } else {
-            filter->filter(row, this->fBitmap.getAddr(0, y), width);
+        const GPixel* row = this->fBitmap.getAddr(0, y);
+        if (filter != nullptr) {
+            filter->filter(filtered.data(), row, width);
+            row = filtered.data();
         }
 
-        for (int x = 0; x < width; ++x) {
-            GPixel src = row[x];
-            GPixel* dest = base->getAddr(x + xOffset, y + yOffset);
+        int baseY = y + yOffset;
+        GPixel* dst = base->getAddr(xOffset, baseY);
+        const uint8_t* coverage = mask != nullptr ? mask->getAddr(xOffset, baseY) : nullptr;
+
+        if (region == nullptr) {
+            blendSpan(row, dst, coverage, width, blendProc);
+            continue;
+        }
 
-            *dest = blendProc(src, *dest);
+        // Only the parts of the row inside the region the layer was saved
+        // under are composited.
+        int count;
+        const GRegion::Span* spans = region->getRow(baseY, &count);
+        for (int i = 0; i < count; ++i) {
+            int left = std::max(spans[i].fLeft - xOffset, 0);
+            int right = std::min(spans[i].fRight - xOffset, width);
+            if (left < right) {
+                blendSpan(row + left, dst + left, coverage != nullptr ? coverage + left : nullptr,
+                          right - left, blendProc);
+            }
         }
     }
 }
@@ -5,6 +5,9 @@
 #include "GMatrix.h"
 #include "GPaint.h"
 #include "GRect.h"
+#include "GRegion.h"
+
+#include "GClipMask.h"
 
 
 /**
@@ -51,25 +54,47 @@ public:
      *
      * When drawing the layers, the filter attached to the layer's paint is
      * first applied to the whole layer. Then each pixel from the layer is
-     * drawn to the base offset by the amount given in the layer's bounds.
+     * drawn to the base offset by the amount given in the layer's bounds,
+     * clipped by the clip the layer was saved under.
      *
      * Args:
      *     base:
      *         A pointer to the bitmap that the layer should be drawn to.
+     *     mask:
+     *         An optional coverage mask the size of the base. If provided,
+     *         each pixel drawn is scaled by its coverage in the mask.
+     *     region:
+     *         An optional region of the base to clip the pixels drawn to.
      */
-    void draw(GBitmap* base);
+    void draw(GBitmap* base, const GClipMask* mask = nullptr, const GRegion* region = nullptr);
 
     bool isLayer() { return fIsLayer; }
     GBitmap& getBitmap() { return fBitmap; }
     GIRect getBounds() { return fBounds; }
     GMatrix& getCTM() { return fCTM; }
 
+    /**
+     * The coverage mask that drawing to the layer is clipped by. A null mask
+     * means drawing is only clipped by the layer's bitmap.
+     */
+    std::shared_ptr<const GClipMask> getClipMask() { return fClipMask; }
+    void setClipMask(std::shared_ptr<const GClipMask> mask) { fClipMask = mask; }
+
+    /**
+     * The region of pixels that drawing to the layer is clipped by, in
+     * addition to the clip mask. A null region places no restriction.
+     */
+    std::shared_ptr<const GRegion> getClipRegion() { return fClipRegion; }
+    void setClipRegion(std::shared_ptr<const GRegion> region) { fClipRegion = region; }
+
 private:
     bool fIsLayer = false;
     GBitmap fBitmap;
     GIRect fBounds;
     GMatrix fCTM;
     GPaint fPaint;
+    std::shared_ptr<const GClipMask> fClipMask;
+    std::shared_ptr<const GRegion> fClipRegion;
 };
 
 
@@ -6,18 +6,15 @@
 #include "GPoint.h"
 #include "GShader.h"
 
-#include "ColorUtils.h"
-#include "MathUtils.h"
+#include "GradientLUT.h"
+#include "SIMD.h"
 
 
 class GLinearGradient : public GShader {
 public:
-    GLinearGradient(GPoint p0, GPoint p1, const GColor colors[], int count, TileMode tile) {
-        fColors = (GColor*) malloc(count * sizeof(GColor));
-        memcpy(fColors, colors, count * sizeof(GColor));
-        fColorCount = count;
-        fTile = tile;
-
+    GLinearGradient(GPoint p0, GPoint p1, const GColor colors[], int count, TileMode tile)
+        : fLUT(colors, count)
+        , fTile(tile) {
         if (p0.fX > p1.fX) {
             std::swap(p0, p1);
         }
@@ -30,10 +27,6 @@ public:
             dy, dx, p0.fY);
     }
 
-    ~GLinearGradient() {
-        free(fColors);
-    }
-
     bool isOpaque() override {
         return false;
     }
@@ -45,58 +38,32 @@ public:
     }
 
     void shadeRow(int x, int y, int count, GPixel row[]) override {
-        for (int i = 0; i < count; ++i) {
-            GPoint point = fLocalMatrix.mapXY(x + i, y);
-
-            float t = point.fX;
-
-            if (fTile == TileMode::kRepeat) {
-                t = t - floor(t);
-            } else if (fTile == TileMode::kMirror) {
-                t *= 0.5;
-                t = t - floor(t);
-                if (t > .5) {
-                    t = 1 - t;
-                }
-                t *= 2;
-            }
-
-            t = clamp(t, 0.0f, 1.0f);
-
-            if (t == 0) {
-                row[i] = colorToPixel(fColors[0].pinToUnit());
-            } else if (t == 1) {
-                row[i] = colorToPixel(fColors[fColorCount - 1].pinToUnit());
-            } else {
-                int index = floor(t * (fColorCount - 1));
-                float span = 1.0f / (fColorCount - 1);
-                float start = index * span;
-
-                GColor c1 = fColors[index].pinToUnit();
-                GColor c2 = fColors[index + 1].pinToUnit();
-
-                t = clamp((t - start) / span, 0.0f, 1.0f);
-
-                GColor color = GColor::MakeARGB(
-                    c1.fA * (1 - t) + c2.fA * t,
-                    c1.fR * (1 - t) + c2.fR * t,
-                    c1.fG * (1 - t) + c2.fG * t,
-                    c1.fB * (1 - t) + c2.fB * t);
-
-                row[i] = colorToPixel(color);
-            }
+        // The position along the gradient is linear in x, so the row's start
+        // is mapped once and every other pixel is a step of dt from it.
+        float t0 = fLocalMatrix.mapXY(x, y).fX;
+        float dt = fLocalMatrix[GMatrix::SX];
+
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            Float4 offsets = Float4_Splat(i) + Float4{ 0, 1, 2, 3 };
+            Float4 t = Float4_Splat(t0) + offsets * Float4_Splat(dt);
+
+            fLUT.lookup4(tileUnit4(t, fTile), &row[i]);
+        }
+
+        for (; i < count; ++i) {
+            row[i] = fLUT.lookup(tileUnit(t0 + i * dt, fTile));
         }
     }
 
 private:
-    GColor* fColors;
-    GMatrix fInverse;
+    // The gradient's colors, converted to pixels once up front.
+    GradientLUT fLUT;
+
     GMatrix fLocalMatrix;
     GMatrix fUnitMatrix;
 
     TileMode fTile;
-
-    int fColorCount;
 };
 
 
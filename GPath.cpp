@@ -1,45 +1,353 @@
+#include <algorithm>
+#include <atomic>
+#include <math.h>
+
 #include "GMatrix.h"
 #include "GPath.h"
 #include "GPoint.h"
 #include "GRect.h"
 
-#include "MathUtils.h"
+#include "SIMD.h"
+
+
+/**
+ * Linearly interpolate between two points.
+ */
+static GPoint lerp(GPoint p0, GPoint p1, float t) {
+    return p0 + (p1 - p0) * t;
+}
+
+
+/**
+ * Find the roots of at^2 + bt + c that lie strictly between 0 and 1.
+ *
+ * Args:
+ *     a, b, c:
+ *         The coefficients of the quadratic.
+ *     roots:
+ *         An array that the roots are written to, in increasing order.
+ *
+ * Returns:
+ *     The number of roots found, which is at most 2.
+ */
+static int findUnitQuadRoots(float a, float b, float c, float roots[2]) {
+    float candidates[2];
+    int candidateCount = 0;
+
+    if (a == 0) {
+        if (b != 0) {
+            candidates[candidateCount++] = -c / b;
+        }
+    } else {
+        float discriminant = b * b - 4 * a * c;
+        if (discriminant < 0) {
+            return 0;
+        }
+
+        // This form avoids cancellation when b is close to the root of the
+        // discriminant.
+        float root = sqrtf(discriminant);
+        float q = b < 0 ? (root - b) / 2 : -(b + root) / 2;
+
+        candidates[candidateCount++] = q / a;
+        if (q != 0) {
+            candidates[candidateCount++] = c / q;
+        }
+    }
+
+    int count = 0;
+    for (int i = 0; i < candidateCount; ++i) {
+        if (candidates[i] > 0 && candidates[i] < 1) {
+            roots[count++] = candidates[i];
+        }
+    }
+
+    if (count == 2) {
+        if (roots[0] > roots[1]) {
+            std::swap(roots[0], roots[1]);
+        } else if (roots[0] == roots[1]) {
+            count = 1;
+        }
+    }
+
+    return count;
+}
 
 
 void GPath::ChopCubicAt(const GPoint src[4], GPoint dst[7], float t) {
-    dst[0] = src[0];
-    dst[1] = GPoint::Make((src[0].x() + src[1].x()) / 2, (src[0].y() + src[1].y()) / 2);
-    dst[2] = src[1];
-    dst[3] = GPoint::Make((src[1].x() + src[2].x()) / 2, (src[1].y() + src[2].y()) / 2);
-    dst[4] = src[2];
-    dst[5] = GPoint::Make((src[2].x() + src[3].x()) / 2, (src[2].y() + src[3].y()) / 2);
-    dst[6] = src[3];
+    // Copy the source first, since callers may chop a curve in place.
+    GPoint p0 = src[0];
+    GPoint p1 = src[1];
+    GPoint p2 = src[2];
+    GPoint p3 = src[3];
+
+    GPoint ab = lerp(p0, p1, t);
+    GPoint bc = lerp(p1, p2, t);
+    GPoint cd = lerp(p2, p3, t);
+    GPoint abc = lerp(ab, bc, t);
+    GPoint bcd = lerp(bc, cd, t);
+
+    dst[0] = p0;
+    dst[1] = ab;
+    dst[2] = abc;
+    dst[3] = lerp(abc, bcd, t);
+    dst[4] = bcd;
+    dst[5] = cd;
+    dst[6] = p3;
 }
 
 
 void GPath::ChopQuadAt(const GPoint src[3], GPoint dst[5], float t) {
-    dst[0] = src[0];
-    dst[1] = GPoint::Make((src[0].x() + src[1].x()) / 2, (src[0].y() + src[1].y()) / 2);
-    dst[2] = src[1];
-    dst[3] = GPoint::Make((src[1].x() + src[2].x()) / 2, (src[1].y() + src[2].y()) / 2);
-    dst[4] = src[2];
+    GPoint p0 = src[0];
+    GPoint p1 = src[1];
+    GPoint p2 = src[2];
+
+    GPoint ab = lerp(p0, p1, t);
+    GPoint bc = lerp(p1, p2, t);
+
+    dst[0] = p0;
+    dst[1] = ab;
+    dst[2] = lerp(ab, bc, t);
+    dst[3] = bc;
+    dst[4] = p2;
+}
+
+
+int GPath::ChopQuadAtYExtrema(const GPoint src[3], GPoint dst[5]) {
+    float denominator = src[0].fY - 2 * src[1].fY + src[2].fY;
+    float t = denominator == 0 ? 0 : (src[0].fY - src[1].fY) / denominator;
+
+    if (t <= 0 || t >= 1) {
+        memcpy(dst, src, 3 * sizeof(GPoint));
+        return 1;
+    }
+
+    ChopQuadAt(src, dst, t);
+
+    // Force the pieces to be exactly flat at the extremum, so rounding can't
+    // make either of them slightly non-monotonic.
+    dst[1].fY = dst[3].fY = dst[2].fY;
+
+    return 2;
+}
+
+
+int GPath::ChopCubicAtYExtrema(const GPoint src[4], GPoint dst[10]) {
+    // The roots of the derivative of y(t), divided by 3
+    float a = src[3].fY - src[0].fY + 3 * (src[1].fY - src[2].fY);
+    float b = 2 * (src[0].fY - 2 * src[1].fY + src[2].fY);
+    float c = src[1].fY - src[0].fY;
+
+    float roots[2];
+    int rootCount = findUnitQuadRoots(a, b, c, roots);
+
+    if (rootCount == 0) {
+        memcpy(dst, src, 4 * sizeof(GPoint));
+        return 1;
+    }
+
+    ChopCubicAt(src, dst, roots[0]);
+    dst[2].fY = dst[4].fY = dst[3].fY;
+
+    if (rootCount == 2) {
+        // The second root has to be rescaled to the remaining piece.
+        float t = (roots[1] - roots[0]) / (1 - roots[0]);
+
+        ChopCubicAt(dst + 3, dst + 3, t);
+        dst[5].fY = dst[7].fY = dst[6].fY;
+    }
+
+    return rootCount + 1;
+}
+
+
+void GPath::EvalQuadAt(const GPoint src[3], const float t[], GPoint dst[], int count) {
+    // P(t) = (At + B)t + C
+    GVector a = (src[0] - src[1]) - (src[1] - src[2]);
+    GVector b = 2 * (src[1] - src[0]);
+    GPoint c = src[0];
+
+    const Float4 ax = Float4_Splat(a.fX), ay = Float4_Splat(a.fY);
+    const Float4 bx = Float4_Splat(b.fX), by = Float4_Splat(b.fY);
+    const Float4 cx = Float4_Splat(c.fX), cy = Float4_Splat(c.fY);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        Float4 tt = { t[i], t[i + 1], t[i + 2], t[i + 3] };
+
+        Float4 x = (ax * tt + bx) * tt + cx;
+        Float4 y = (ay * tt + by) * tt + cy;
+
+        for (int lane = 0; lane < 4; ++lane) {
+            dst[i + lane].set(x[lane], y[lane]);
+        }
+    }
+
+    for (; i < count; ++i) {
+        dst[i] = c + (a * t[i] + b) * t[i];
+    }
+}
+
+
+void GPath::EvalCubicAt(const GPoint src[4], const float t[], GPoint dst[], int count) {
+    // P(t) = ((At + B)t + C)t + D
+    GVector a = (src[3] - src[0]) + 3 * (src[1] - src[2]);
+    GVector b = 3 * ((src[0] - src[1]) - (src[1] - src[2]));
+    GVector c = 3 * (src[1] - src[0]);
+    GPoint d = src[0];
+
+    const Float4 ax = Float4_Splat(a.fX), ay = Float4_Splat(a.fY);
+    const Float4 bx = Float4_Splat(b.fX), by = Float4_Splat(b.fY);
+    const Float4 cx = Float4_Splat(c.fX), cy = Float4_Splat(c.fY);
+    const Float4 dx = Float4_Splat(d.fX), dy = Float4_Splat(d.fY);
+
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        Float4 tt = { t[i], t[i + 1], t[i + 2], t[i + 3] };
+
+        Float4 x = ((ax * tt + bx) * tt + cx) * tt + dx;
+        Float4 y = ((ay * tt + by) * tt + cy) * tt + dy;
+
+        for (int lane = 0; lane < 4; ++lane) {
+            dst[i + lane].set(x[lane], y[lane]);
+        }
+    }
+
+    for (; i < count; ++i) {
+        dst[i] = d + ((a * t[i] + b) * t[i] + c) * t[i];
+    }
+}
+
+
+bool GPath::operator==(const GPath& other) const {
+    if (this->fRef == other.fRef) {
+        return true;
+    }
+
+    return this->fRef->fVbs == other.fRef->fVbs && this->fRef->fPts == other.fRef->fPts;
+}
+
+
+// The distance along the tangent to place the control points of a cubic
+// approximating a quarter circle: 4/3 * (sqrt(2) - 1).
+static const float kCircleKappa = 0.552284749831f;
+
+
+/**
+ * Compute the 13 points of an oval made from 4 cubics, in the order they are
+ * added to a path.
+ *
+ * Args:
+ *     rect:
+ *         The rectangle the oval is inscribed in.
+ *     dir:
+ *         The direction to traverse the oval.
+ *     pts:
+ *         The array the points are written to.
+ */
+static void ovalPoints(const GRect& rect, GPath::Direction dir, GPoint pts[13]) {
+    float cx = (rect.left() + rect.right()) / 2;
+    float cy = (rect.top() + rect.bottom()) / 2;
+    float kx = kCircleKappa * rect.width() / 2;
+    float ky = kCircleKappa * rect.height() / 2;
+
+    // With y pointing down, "below" the center comes first when traversing
+    // clockwise.
+    float nextY = rect.bottom();
+    float lastY = rect.top();
+    if (dir == GPath::kCCW_Direction) {
+        std::swap(nextY, lastY);
+        ky = -ky;
+    }
+
+    pts[0] = GPoint::Make(rect.right(), cy);
+    pts[1] = GPoint::Make(rect.right(), cy + ky);
+    pts[2] = GPoint::Make(cx + kx, nextY);
+    pts[3] = GPoint::Make(cx, nextY);
+    pts[4] = GPoint::Make(cx - kx, nextY);
+    pts[5] = GPoint::Make(rect.left(), cy + ky);
+    pts[6] = GPoint::Make(rect.left(), cy);
+    pts[7] = GPoint::Make(rect.left(), cy - ky);
+    pts[8] = GPoint::Make(cx - kx, lastY);
+    pts[9] = GPoint::Make(cx, lastY);
+    pts[10] = GPoint::Make(cx + kx, lastY);
+    pts[11] = GPoint::Make(rect.right(), cy - ky);
+    pts[12] = pts[0];
+}
+
+
+GPath& GPath::addOval(const GRect& rect, Direction dir) {
+    GPoint pts[13];
+    ovalPoints(rect, dir, pts);
+
+    this->reserve(13, 5);
+    this->moveTo(pts[0]);
+    for (int i = 1; i < 13; i += 3) {
+        this->cubicTo(pts[i], pts[i + 1], pts[i + 2]);
+    }
+
+    return *this;
 }
 
 
 GPath& GPath::addCircle(GPoint center, float radius, Direction dir) {
     GRect rect = GRect::MakeLTRB(
-        center.x() - radius / 2,
-        center.y() - radius / 2,
-        center.x() + radius / 2,
-        center.y() + radius/ 2);
+        center.x() - radius,
+        center.y() - radius,
+        center.x() + radius,
+        center.y() + radius);
 
-    return this->addRect(rect, dir);
+    return this->addOval(rect, dir);
+}
+
+
+bool GPath::isOval(GRect* bounds) const {
+    if (this->fRef->fVbs.size() != 5 || this->fRef->fVbs[0] != kMove) {
+        return false;
+    }
+
+    for (int i = 1; i < 5; ++i) {
+        if (this->fRef->fVbs[i] != kCubic) {
+            return false;
+        }
+    }
+
+    GRect rect = this->bounds();
+    if (rect.isEmpty()) {
+        return false;
+    }
+
+    // The points only have to be close to the ideal oval, so that ovals that
+    // have been transformed by a scale or translate are still recognized.
+    float tolerance = 1e-4f * std::max(rect.width(), rect.height());
+
+    GPoint cw[13], ccw[13];
+    ovalPoints(rect, kCW_Direction, cw);
+    ovalPoints(rect, kCCW_Direction, ccw);
+
+    bool matchesCW = true;
+    bool matchesCCW = true;
+    for (int i = 0; i < 13; ++i) {
+        GVector dcw = this->fRef->fPts[i] - cw[i];
+        GVector dccw = this->fRef->fPts[i] - ccw[i];
+
+        matchesCW &= fabsf(dcw.x()) <= tolerance && fabsf(dcw.y()) <= tolerance;
+        matchesCCW &= fabsf(dccw.x()) <= tolerance && fabsf(dccw.y()) <= tolerance;
+    }
+
+    if (!matchesCW && !matchesCCW) {
+        return false;
+    }
+
+    *bounds = rect;
+    return true;
 }
 
 
 GPath& GPath::addPolygon(const GPoint pts[], int count) {
     if (count <= 1) { return *this; }
 
+    this->reserve(count, count);
     this->moveTo(pts[0]);
     for (int i = 1; i < count; ++i) {
         this->lineTo(pts[i]);
@@ -50,6 +358,7 @@ GPath& GPath::addPolygon(const GPoint pts[], int count) {
 
 
 GPath& GPath::addRect(const GRect& rect, Direction dir) {
+    this->reserve(4, 4);
     this->moveTo(GPoint::Make(rect.left(), rect.top()));
 
     if (dir == Direction::kCW_Direction) {
@@ -66,27 +375,127 @@ GPath& GPath::addRect(const GRect& rect, Direction dir) {
 }
 
 
-GRect GPath::bounds() const {
-    int count = this->fPts.size();
+uint32_t GPath::getGenerationID() const {
+    static std::atomic<uint32_t> nextID(1);
 
-    if (count == 0) {
-        return GRect::MakeWH(0, 0);
+    uint32_t id = this->fRef->fGenerationID.load(std::memory_order_relaxed);
+    if (id == 0) {
+        // Skip 0 if the counter ever wraps around, since it means "unassigned"
+        uint32_t next;
+        do {
+            next = nextID++;
+        } while (next == 0);
+
+        // Another thread sharing the storage may have assigned an ID first,
+        // in which case every copy uses that one.
+        if (this->fRef->fGenerationID.compare_exchange_strong(
+                id, next, std::memory_order_relaxed)) {
+            id = next;
+        }
     }
 
-    float xVals[count], yVals[count];
+    return id;
+}
+
+
+void GPath::transform(const GMatrix& matrix) {
+    PathRef* ref = this->writableRef();
+    matrix.mapPoints(ref->fPts.data(), ref->fPts.data(), ref->fPts.size());
+
+    // Every point moved, so the bounds have to be rebuilt from scratch.
+    ref->computeBounds();
+    ref->fConvexity = kUnknown_Convexity;
+}
+
+
+/**
+ * Get the sign of a number as -1, 0, or 1.
+ */
+static int sign(float x) {
+    return (x > 0) - (x < 0);
+}
+
+
+/**
+ * Determine if a closed polygon is convex. Every turn must be in the same
+ * direction, and the direction of travel along each axis may only reverse
+ * twice, which rules out polygons like stars that turn the same way but wrap
+ * around more than once.
+ *
+ * Args:
+ *     pts:
+ *         The vertices of the polygon. Repeated points are ignored.
+ *     count:
+ *         The number of vertices.
+ */
+static bool isPolygonConvex(const GPoint pts[], int count) {
+    // Drop repeated points, including a closing point equal to the first.
+    std::vector<GPoint> vertices;
     for (int i = 0; i < count; ++i) {
-        xVals[i] = fPts[i].fX;
-        yVals[i] = fPts[i].fY;
+        if (vertices.empty() || vertices.back() != pts[i]) {
+            vertices.push_back(pts[i]);
+        }
+    }
+    while (vertices.size() > 1 && vertices.back() == vertices.front()) {
+        vertices.pop_back();
+    }
+
+    int n = vertices.size();
+    if (n < 3) {
+        return true;
     }
 
-    return GRect::MakeLTRB(
-        manyMin(xVals, count),
-        manyMin(yVals, count),
-        manyMax(xVals, count),
-        manyMax(yVals, count));
+    int turn = 0;
+    int xChanges = 0;
+    int yChanges = 0;
+    int lastDx = 0;
+    int lastDy = 0;
+
+    // Go around one extra time so the direction changes at the start are
+    // compared against the end of the polygon.
+    for (int i = 0; i < 2 * n; ++i) {
+        GVector prev = vertices[(i + 1) % n] - vertices[i % n];
+        GVector next = vertices[(i + 2) % n] - vertices[(i + 1) % n];
+
+        int cross = sign(prev.x() * next.y() - prev.y() * next.x());
+        if (cross != 0) {
+            if (turn != 0 && cross != turn) {
+                return false;
+            }
+            turn = cross;
+        }
+
+        // Only count changes on the second lap, once the direction of the
+        // last edge is known.
+        int dx = sign(next.x());
+        if (dx != 0) {
+            xChanges += i >= n && dx != lastDx;
+            lastDx = dx;
+        }
+
+        int dy = sign(next.y());
+        if (dy != 0) {
+            yChanges += i >= n && dy != lastDy;
+            lastDy = dy;
+        }
+    }
+
+    return xChanges <= 2 && yChanges <= 2;
 }
 
 
-void GPath::transform(const GMatrix& matrix) {
-    matrix.mapPoints(this->fPts.data(), this->fPts.data(), this->fPts.size());
+bool GPath::isConvex() const {
+    Convexity convexity = this->fRef->fConvexity.load(std::memory_order_relaxed);
+
+    if (convexity == kUnknown_Convexity) {
+        // The control points of each curve are treated as part of the
+        // polygon, since a curve with a convex control polygon is convex.
+        bool convex = this->countVerbs(kMove) == 1
+            && isPolygonConvex(this->fRef->fPts.data(), this->fRef->fPts.size());
+
+        convexity = convex ? kConvex_Convexity : kConcave_Convexity;
+        this->fRef->fConvexity.store(convexity, std::memory_order_relaxed);
+    }
+
+    return convexity == kConvex_Convexity;
 }
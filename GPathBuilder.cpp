@@ -0,0 +1,40 @@
+#include <memory>
+
+#include "GArena.h"
+#include "GPath.h"
+#include "GPathBuilder.h"
+
+
+GPathBuilder::GPathBuilder(GArena* arena) : fArena(arena) {
+    this->startPath();
+}
+
+
+GPathBuilder& GPathBuilder::reserve(int points, int verbs) {
+    this->fPath.reserve(points, verbs);
+    return *this;
+}
+
+
+GPath GPathBuilder::detach() {
+    GPath path = this->fPath;
+    this->startPath();
+
+    return path;
+}
+
+
+/**
+ * Give the path being built its own storage. With an arena, even the storage's
+ * reference count is allocated from it.
+ */
+void GPathBuilder::startPath() {
+    if (this->fArena == nullptr) {
+        this->fPath = GPath();
+        return;
+    }
+
+    this->fPath.fRef = std::allocate_shared<GPath::PathRef>(
+        GArenaAllocator<GPath::PathRef>(this->fArena),
+        this->fArena);
+}
@@ -8,10 +8,13 @@
 #include "GPoint.h"
 #include "GShader.h"
 
+#include "GradientLUT.h"
+
 
 class GRadialGradient : public GShader {
 public:
-    GRadialGradient(GPoint center, float radius, const GColor colors[], int count);
+    GRadialGradient(GPoint center, float radius, const GColor colors[], int count,
+                    TileMode tile = kClamp);
 
     bool isOpaque();
     bool setContext(const GMatrix& ctm);
@@ -21,8 +24,9 @@ private:
     GPoint fCenter;
     float fRadius;
 
-    GColor* fColors;
-    int fColorCount;
+    // The gradient's colors, converted to pixels once up front.
+    GradientLUT fLUT;
+    TileMode fTile;
 
     GMatrix fLocalMatrix;
 };
@@ -0,0 +1,248 @@
+#include <algorithm>
+
+#include "GRect.h"
+#include "GRegion.h"
+
+
+/**
+ * Determine if a pixel belongs in the result of a region operation.
+ *
+ * Args:
+ *     inA:
+ *         Whether the pixel is in the first region.
+ *     inB:
+ *         Whether the pixel is in the second region.
+ *     op:
+ *         The operation being performed.
+ */
+static bool opContains(bool inA, bool inB, GRegion::Op op) {
+    switch (op) {
+        case GRegion::kUnion_Op:
+            return inA || inB;
+        case GRegion::kIntersect_Op:
+            return inA && inB;
+        case GRegion::kDifference_Op:
+            return inA && !inB;
+    }
+
+    return false;
+}
+
+
+/**
+ * Get the x-coordinate of one end of a span in a row. Ends are numbered in
+ * order along the row, so even ends are left sides and odd ends are right
+ * sides, and a point is inside the row between an even end and the next.
+ */
+static inline int32_t spanEnd(const GRegion::Span* spans, int end) {
+    const GRegion::Span& span = spans[end >> 1];
+    return (end & 1) ? span.fRight : span.fLeft;
+}
+
+
+/**
+ * Combine the spans of two rows. Both rows are already sorted, so their ends
+ * are merged in a single pass from left to right.
+ *
+ * Args:
+ *     a:
+ *         The sorted spans of the first row.
+ *     aCount:
+ *         The number of spans in 'a'.
+ *     b:
+ *         The sorted spans of the second row.
+ *     bCount:
+ *         The number of spans in 'b'.
+ *     op:
+ *         The operation used to combine the rows.
+ *     result:
+ *         The vector that the combined, sorted spans are written to.
+ */
+static void combineSpans(
+        const GRegion::Span* a,
+        int aCount,
+        const GRegion::Span* b,
+        int bCount,
+        GRegion::Op op,
+        std::vector<GRegion::Span>* result) {
+    result->clear();
+
+    const int aEnds = 2 * aCount;
+    const int bEnds = 2 * bCount;
+    int aEnd = 0;
+    int bEnd = 0;
+
+    bool inside = false;
+    int32_t start = 0;
+    while (aEnd < aEnds || bEnd < bEnds) {
+        int32_t x;
+        if (bEnd == bEnds || (aEnd < aEnds && spanEnd(a, aEnd) < spanEnd(b, bEnd))) {
+            x = spanEnd(a, aEnd);
+        } else {
+            x = spanEnd(b, bEnd);
+        }
+
+        // Step past every end at x, including spans that touch.
+        while (aEnd < aEnds && spanEnd(a, aEnd) == x) {
+            aEnd++;
+        }
+        while (bEnd < bEnds && spanEnd(b, bEnd) == x) {
+            bEnd++;
+        }
+
+        bool contains = opContains(aEnd & 1, bEnd & 1, op);
+        if (contains && !inside) {
+            start = x;
+        } else if (!contains && inside) {
+            result->push_back({ start, x });
+        }
+        inside = contains;
+    }
+}
+
+
+GRegion::GRegion(const GIRect& rect) {
+    if (!rect.isEmpty()) {
+        std::vector<Span> spans = { { rect.left(), rect.right() } };
+        this->appendBand(rect.top(), rect.bottom(), spans);
+    }
+}
+
+
+GIRect GRegion::getBounds() const {
+    if (this->isEmpty()) {
+        return GIRect::MakeWH(0, 0);
+    }
+
+    int32_t left = this->fSpans.front().fLeft;
+    int32_t right = this->fSpans.front().fRight;
+    for (const Band& band : this->fBands) {
+        left = std::min(left, this->fSpans[band.fSpanStart].fLeft);
+        right = std::max(right, this->fSpans[band.fSpanStart + band.fSpanCount - 1].fRight);
+    }
+
+    return GIRect::MakeLTRB(left, this->fBands.front().fTop, right, this->fBands.back().fBottom);
+}
+
+
+bool GRegion::contains(int x, int y) const {
+    int count;
+    const Span* spans = this->getRow(y, &count);
+
+    for (int i = 0; i < count; ++i) {
+        if (spans[i].fLeft <= x && x < spans[i].fRight) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+
+void GRegion::translate(int dx, int dy) {
+    for (Band& band : this->fBands) {
+        band.fTop += dy;
+        band.fBottom += dy;
+    }
+
+    for (Span& span : this->fSpans) {
+        span.fLeft += dx;
+        span.fRight += dx;
+    }
+}
+
+
+void GRegion::op(const GRegion& other, Op op) {
+    std::vector<int32_t> ys;
+    for (const Band& band : this->fBands) {
+        ys.push_back(band.fTop);
+        ys.push_back(band.fBottom);
+    }
+    for (const Band& band : other.fBands) {
+        ys.push_back(band.fTop);
+        ys.push_back(band.fBottom);
+    }
+
+    std::sort(ys.begin(), ys.end());
+    ys.erase(std::unique(ys.begin(), ys.end()), ys.end());
+
+    GRegion result;
+    std::vector<Span> spans;
+
+    // Every interval between consecutive y-coordinates is covered by at most
+    // one band from each region, so we can combine them row by row.
+    size_t aIndex = 0;
+    size_t bIndex = 0;
+    for (size_t i = 0; i + 1 < ys.size(); ++i) {
+        int32_t y = ys[i];
+
+        while (aIndex < this->fBands.size() && this->fBands[aIndex].fBottom <= y) {
+            aIndex++;
+        }
+        while (bIndex < other.fBands.size() && other.fBands[bIndex].fBottom <= y) {
+            bIndex++;
+        }
+
+        const Span* aSpans = nullptr;
+        int aCount = 0;
+        if (aIndex < this->fBands.size() && this->fBands[aIndex].fTop <= y) {
+            aSpans = &this->fSpans[this->fBands[aIndex].fSpanStart];
+            aCount = this->fBands[aIndex].fSpanCount;
+        }
+
+        const Span* bSpans = nullptr;
+        int bCount = 0;
+        if (bIndex < other.fBands.size() && other.fBands[bIndex].fTop <= y) {
+            bSpans = &other.fSpans[other.fBands[bIndex].fSpanStart];
+            bCount = other.fBands[bIndex].fSpanCount;
+        }
+
+        combineSpans(aSpans, aCount, bSpans, bCount, op, &spans);
+        result.appendBand(y, ys[i + 1], spans);
+    }
+
+    *this = result;
+}
+
+
+const GRegion::Span* GRegion::getRow(int y, int* count) const {
+    // Find the first band that ends below the row
+    auto band = std::upper_bound(
+        this->fBands.begin(),
+        this->fBands.end(),
+        y,
+        [](int y, const Band& band) { return y < band.fBottom; });
+
+    if (band == this->fBands.end() || band->fTop > y) {
+        *count = 0;
+        return nullptr;
+    }
+
+    *count = band->fSpanCount;
+    return &this->fSpans[band->fSpanStart];
+}
+
+
+/**
+ * Add a band to the bottom of the region. Empty bands are dropped, and a band
+ * that continues the previous band with the same spans is merged into it.
+ */
+void GRegion::appendBand(int top, int bottom, const std::vector<Span>& spans) {
+    if (spans.empty() || top >= bottom) {
+        return;
+    }
+
+    if (!this->fBands.empty()) {
+        Band& last = this->fBands.back();
+
+        if (last.fBottom == top
+                && last.fSpanCount == (int) spans.size()
+                && std::equal(spans.begin(), spans.end(), this->fSpans.begin() + last.fSpanStart)) {
+            last.fBottom = bottom;
+            return;
+        }
+    }
+
+    this->fBands.push_back({ top, bottom, (int) this->fSpans.size(), (int) spans.size() });
+    this->fSpans.insert(this->fSpans.end(), spans.begin(), spans.end());
+}
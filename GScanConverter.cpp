@@ -1,5 +1,6 @@
 #include <algorithm>
 #include <iostream>
+#include <math.h>
 #include <vector>
 
 #include "GBlitter.h"
@@ -10,103 +11,113 @@
 #include "Clipper.h"
 
 
-void GScanConverter::scan(Edge* edges, int count, GBlitter& blitter) {
+void GScanConverter::scan(Edge* edges, int count, CurveEdge curves[], GBlitter& blitter) {
     GASSERT(count >= 2);
 
-    std::sort(edges, edges + count);
+    // Edges that come from a cache are usually still sorted.
+    if (!std::is_sorted(edges, edges + count)) {
+        std::sort(edges, edges + count);
+    }
 
-    int lastY = edges[count - 1].bottomY;
+    int lastY = edges[0].lastY(curves);
+    for (int i = 1; i < count; ++i) {
+        lastY = std::max(lastY, edges[i].lastY(curves));
+    }
 
-    // Set up our initial left and right boundary edges
-    Edge left = edges[0];
-    Edge right = edges[1];
+    // A convex figure crosses each row exactly twice, so we only ever need to
+    // track two edges. Which of them is on the left doesn't matter.
+    Edge a = edges[0];
+    Edge b = edges[1];
 
     // Track index of next edge position
     int next = 2;
 
-    float curY = left.topY;
-
-    float leftX = left.curX;
-    float rightX = right.curX;
-
-    // Loop through all the possible y-coordinates that could be drawn
-    while (curY < lastY) {
-        blitter.blitRow(curY, GRoundToInt(leftX), GRoundToInt(rightX));
-        curY++;
-
-        // After drawing, we check to see if we've completed either the
-        // left or right edge. If we have, we replace it with the next
-        // edge.
-
-        if (curY > left.bottomY) {
-            left = edges[next];
-            next++;
-
-            leftX = left.curX;
-        } else {
-            leftX += left.dxdy;
+    for (int y = a.topY; y < lastY; ++y) {
+        // Replace each edge that has finished with its next curve segment if
+        // it has one, or else with the next edge to start.
+        if (y >= a.bottomY && !a.nextCurveSegment(curves)) {
+            if (next >= count) {
+                break;
+            }
+            a = edges[next++];
         }
 
-        if (curY > right.bottomY) {
-            right = edges[next];
-            next++;
-
-            rightX = right.curX;
-        } else {
-            rightX += right.dxdy;
+        if (y >= b.bottomY && !b.nextCurveSegment(curves)) {
+            if (next >= count) {
+                break;
+            }
+            b = edges[next++];
         }
-    }
-}
-
 
-int getEdgeIndex(Edge* edge, std::vector<Edge*> edges) {
-    int pos = std::find(edges.begin(), edges.end(), edge) - edges.begin();
+        int x0 = GRoundToInt(a.curX);
+        int x1 = GRoundToInt(b.curX);
+        blitter.blitRow(y, std::min(x0, x1), std::max(x0, x1));
 
-    if (pos >= edges.size()) {
-        // Couldn't find edge
-        GASSERT(false);
+        a.curX += a.dxdy;
+        b.curX += b.dxdy;
     }
-
-    return pos;
 }
 
 
-bool isEdgeLess(Edge* first, Edge* second) {
-    return first->curX <= second->curX;
-}
-
+/**
+ * Sort active edges by their x-coordinate on the current row. Edges only move
+ * a little from one row to the next, so the list is nearly sorted already and
+ * an insertion sort takes close to linear time.
+ */
+static void sortActiveEdges(std::vector<Edge*>& active) {
+    for (size_t i = 1; i < active.size(); ++i) {
+        Edge* edge = active[i];
 
-void resortBackwards(Edge* edge, std::vector<Edge*>& edges) {
-    int pos = getEdgeIndex(edge, edges);
-
-    std::sort(edges.begin(), edges.begin() + pos + 1, isEdgeLess);
+        size_t j = i;
+        while (j > 0 && active[j - 1]->curX > edge->curX) {
+            active[j] = active[j - 1];
+            --j;
+        }
+        active[j] = edge;
+    }
 }
 
 
 // Note that unlike the simple scan converter, this one is "destructive"
 // because it manipulates each edge's 'curX' property. This is unlikely to
 // matter since we don't do anything with the edges after drawing them.
-void GScanConverter::scanComplex(Edge* edges, int count, GBlitter& blitter) {
+void GScanConverter::scanComplex(Edge* edges, int count, CurveEdge curves[], GBlitter& blitter) {
     GASSERT(count >= 2);
 
-    std::sort(edges, edges + count);
+    // Edges that come from a cache are usually still sorted.
+    if (!std::is_sorted(edges, edges + count)) {
+        std::sort(edges, edges + count);
+    }
 
-    std::vector<Edge*> edgeVec;
+    // Curve edges grow downwards as they are stepped, so the last row has to
+    // come from each edge's final extent rather than its first segment.
+    int maxY = edges[0].topY;
     for (int i = 0; i < count; ++i) {
-        edgeVec.push_back(&edges[i]);
+        maxY = std::max(maxY, edges[i].lastY(curves));
     }
 
-    int minY = edgeVec.front()->topY;
-    int maxY = edgeVec.back()->bottomY;
+    // Only the edges that cross the current row are looked at, so each row
+    // costs time in proportion to its own edges rather than the whole path's.
+    std::vector<Edge*> active;
+    int next = 0;
 
-    for (int y = minY; y < maxY;) {
-        int wind = 0;
-        Edge* edge = edgeVec.front();
-        Edge* next;
+    for (int y = edges[0].topY; y < maxY;) {
+        if (active.empty()) {
+            if (next >= count) {
+                break;
+            }
+            y = std::max(y, edges[next].topY);
+        }
 
-        int x0, x1;
+        while (next < count && edges[next].topY <= y) {
+            active.push_back(&edges[next++]);
+        }
+
+        sortActiveEdges(active);
 
-        while (edge != nullptr && edge->topY <= y) {
+        int wind = 0;
+        int x0 = 0;
+        for (Edge* edge : active) {
             if (wind == 0) {
                 x0 = GRoundToInt(edge->curX);
             }
@@ -114,39 +125,210 @@ void GScanConverter::scanComplex(Edge* edges, int count, GBlitter& blitter) {
             wind += edge->wind;
 
             if (wind == 0) {
-                x1 = GRoundToInt(edge->curX);
-                blitter.blitRow(y, x0, x1);
+                int x1 = GRoundToInt(edge->curX);
+                if (x0 < x1) {
+                    blitter.blitRow(y, x0, x1);
+                }
             }
+        }
 
-            int nextIndex = getEdgeIndex(edge, edgeVec) + 1;
-            if (nextIndex >= edgeVec.size()) {
-                next = nullptr;
+        // Step every edge to the next row, dropping the ones that end here.
+        // A curve edge only produces its next segment once the previous one
+        // is finished, which starts on the next row.
+        size_t kept = 0;
+        for (Edge* edge : active) {
+            if (edge->bottomY <= y + 1) {
+                if (!edge->nextCurveSegment(curves)) {
+                    continue;
+                }
             } else {
-                next = edgeVec[nextIndex];
+                edge->curX += edge->dxdy;
             }
+            active[kept++] = edge;
+        }
+        active.resize(kept);
 
-            if (edge->bottomY == y + 1) {
-                edgeVec.erase(edgeVec.begin() + getEdgeIndex(edge, edgeVec));
-            } else {
-                edge->curX += edge->dxdy;
-                resortBackwards(edge, edgeVec);
+        y++;
+    }
+}
+
+
+
+/**
+ * Find the pixels whose centers lie between the start and end of a segment
+ * along one axis. Going up the axis, these are the centers c with
+ * start < c <= end, and going down, those with end <= c < start. Either way
+ * the end is included and the start is not.
+ *
+ * Args:
+ *     start, end:
+ *         The coordinates of the segment's ends along the axis.
+ *     lo, hi:
+ *         Set to the half-open range of pixels the segment covers.
+ */
+static void hairlineRange(float start, float end, int* lo, int* hi) {
+    if (start <= end) {
+        *lo = GRoundToInt(start);
+        *hi = GRoundToInt(end);
+    } else {
+        *lo = GCeilToInt(end - 0.5f);
+        *hi = GCeilToInt(start - 0.5f);
+    }
+}
+
+
+/**
+ * Draw one segment of a hairline whose x distance is at least its y distance.
+ * Neighboring pixels that land on the same row are drawn as a single span.
+ */
+static void hairlineXMajor(GPoint p0, GPoint p1, const GRect& bounds, GBlitter& blitter) {
+    int left, right;
+    hairlineRange(p0.fX, p1.fX, &left, &right);
+    left = std::max(left, GRoundToInt(bounds.left()));
+    right = std::min(right, GRoundToInt(bounds.right()));
+    if (left >= right) {
+        return;
+    }
+
+    int top = GRoundToInt(bounds.top());
+    int bottom = GRoundToInt(bounds.bottom());
+
+    float slope = (p1.fY - p0.fY) / (p1.fX - p0.fX);
+    float y = p0.fY + (left + 0.5f - p0.fX) * slope;
+
+    int runLeft = left;
+    int runY = GFloorToInt(y);
+    for (int x = left + 1; x < right; ++x) {
+        y += slope;
+
+        int row = GFloorToInt(y);
+        if (row != runY) {
+            if (runY >= top && runY < bottom) {
+                blitter.blitRow(runY, runLeft, x);
             }
+            runLeft = x;
+            runY = row;
+        }
+    }
+
+    if (runY >= top && runY < bottom) {
+        blitter.blitRow(runY, runLeft, right);
+    }
+}
+
+
+/**
+ * Draw one segment of a hairline whose y distance is more than its x distance.
+ */
+static void hairlineYMajor(GPoint p0, GPoint p1, const GRect& bounds, GBlitter& blitter) {
+    int top, bottom;
+    hairlineRange(p0.fY, p1.fY, &top, &bottom);
+    top = std::max(top, GRoundToInt(bounds.top()));
+    bottom = std::min(bottom, GRoundToInt(bounds.bottom()));
+
+    float slope = (p1.fX - p0.fX) / (p1.fY - p0.fY);
+    float x = p0.fX + (top + 0.5f - p0.fY) * slope;
+
+    for (int y = top; y < bottom; ++y) {
+        int column = GFloorToInt(x);
+        blitter.blitRow(y, column, column + 1);
+        x += slope;
+    }
+}
+
 
-            edge = next;
+
+/**
+ * Passes rows on to another blitter, leaving out the pixels that hold the
+ * two ends of a hairline segment.
+ */
+class SegmentBlitter : public GBlitter {
+public:
+    SegmentBlitter(GBlitter& blitter, GPoint p0, GPoint p1)
+        : fBlitter(blitter)
+        , fX0(GFloorToInt(p0.fX))
+        , fY0(GFloorToInt(p0.fY))
+        , fX1(GFloorToInt(p1.fX))
+        , fY1(GFloorToInt(p1.fY)) {}
+
+    void blitRow(int y, int xLeft, int xRight) override {
+        int cuts[2];
+        int cutCount = 0;
+        if (y == fY0 && fX0 >= xLeft && fX0 < xRight) {
+            cuts[cutCount++] = fX0;
+        }
+        if (y == fY1 && fX1 >= xLeft && fX1 < xRight && !(y == fY0 && fX1 == fX0)) {
+            cuts[cutCount++] = fX1;
+        }
+        if (cutCount == 2 && cuts[1] < cuts[0]) {
+            std::swap(cuts[0], cuts[1]);
         }
 
-        y++;
+        for (int i = 0; i < cutCount; ++i) {
+            if (xLeft < cuts[i]) {
+                fBlitter.blitRow(y, xLeft, cuts[i]);
+            }
+            xLeft = cuts[i] + 1;
+        }
 
-        while (edge != nullptr && edge->topY == y) {
-            int nextIndex = getEdgeIndex(edge, edgeVec) + 1;
-            if (nextIndex >= edgeVec.size()) {
-                next = nullptr;
-            } else {
-                next = edgeVec[nextIndex];
+        if (xLeft < xRight) {
+            fBlitter.blitRow(y, xLeft, xRight);
+        }
+    }
+
+private:
+    GBlitter& fBlitter;
+    int fX0;
+    int fY0;
+    int fX1;
+    int fY1;
+};
+
+
+void GScanConverter::hairline(const GPoint pts[], int count, const GRect& bounds, GBlitter& blitter) {
+    if (count < 2) {
+        return;
+    }
+
+    // Where the polyline turns, the pixel holding the vertex may have no
+    // center on either segment, so segments leave out their end pixels and
+    // each vertex's pixel is drawn on its own.
+    for (int i = 0; i + 1 < count; ++i) {
+        GPoint p0 = pts[i];
+        GPoint p1 = pts[i + 1];
+        SegmentBlitter segmentBlitter(blitter, p0, p1);
+
+        if (fabsf(p1.fX - p0.fX) >= fabsf(p1.fY - p0.fY)) {
+            if (p0.fX != p1.fX) {
+                hairlineXMajor(p0, p1, bounds, segmentBlitter);
             }
+        } else {
+            hairlineYMajor(p0, p1, bounds, segmentBlitter);
+        }
+    }
 
-            resortBackwards(edge, edgeVec);
-            edge = next;
+    int left = GRoundToInt(bounds.left());
+    int top = GRoundToInt(bounds.top());
+    int right = GRoundToInt(bounds.right());
+    int bottom = GRoundToInt(bounds.bottom());
+
+    int firstX = GFloorToInt(pts[0].fX);
+    int firstY = GFloorToInt(pts[0].fY);
+    int prevX = 0;
+    int prevY = 0;
+    for (int i = 0; i < count; ++i) {
+        int x = GFloorToInt(pts[i].fX);
+        int y = GFloorToInt(pts[i].fY);
+
+        // Vertices that share a pixel with the one before them, or a closed
+        // contour's last vertex, have already been drawn.
+        bool drawn = (i > 0 && x == prevX && y == prevY)
+            || (i == count - 1 && x == firstX && y == firstY);
+        prevX = x;
+        prevY = y;
+
+        if (!drawn && x >= left && x < right && y >= top && y < bottom) {
+            blitter.blitRow(y, x, x + 1);
         }
     }
 }
@@ -1,8 +1,13 @@
 #ifndef GScanConverter_DEFINED
 #define GScanConverter_DEFINED
 
+#include "GPoint.h"
+#include "GRect.h"
+
 #include "Clipper.h"
 
+class GBlitter;
+
 
 class GScanConverter {
 public:
@@ -14,10 +19,13 @@ public:
      *         A pointer to the beginning of the array of edges to blit.
      *     count:
      *         The number of edges in the array.
+     *     curves:
+     *         The array of curve edges the edges were built with, which may
+     *         be null if they are all line edges.
      *     blitter:
      *         The blitter to use to actually draw each row of pixels.
      */
-    static void scan(Edge* edges, int count, GBlitter& blitter);
+    static void scan(Edge* edges, int count, CurveEdge curves[], GBlitter& blitter);
 
     /**
      * Scan converter to blit a set of edges that form a closed figure. Note
@@ -28,10 +36,35 @@ public:
      *         A pointer to the beginning of the array of edges to blit.
      *     count:
      *         The number of edges in the array.
+     *     curves:
+     *         The array of curve edges the edges were built with, which may
+     *         be null if they are all line edges.
      *     blitter:
      *         The blitter to use to actually draw each row of pixels.
      */
-    static void scanComplex(Edge* edges, int count, GBlitter& blitter);
+    static void scanComplex(Edge* edges, int count, CurveEdge curves[], GBlitter& blitter);
+
+    /**
+     * Draw a one pixel wide line through a series of points, stepping along
+     * each segment's major axis and drawing the pixel nearest the segment in
+     * each column or row. No edges are built, so nothing has to be sorted.
+     *
+     * Each segment covers the pixels whose centers it passes along its major
+     * axis, apart from the pixels holding its two ends. The pixel holding each
+     * vertex is then drawn once, so a vertex is never skipped or drawn twice
+     * however the polyline turns there.
+     *
+     * Args:
+     *     pts:
+     *         The device space points of the polyline.
+     *     count:
+     *         The number of points.
+     *     bounds:
+     *         The device space rectangle to clip the line to.
+     *     blitter:
+     *         The blitter to use to draw the pixels.
+     */
+    static void hairline(const GPoint pts[], int count, const GRect& bounds, GBlitter& blitter);
 };
 
 
@@ -0,0 +1,420 @@
+#include <math.h>
+#include <vector>
+
+#include "GPath.h"
+#include "GPoint.h"
+#include "GRect.h"
+#include "GStroke.h"
+
+#include "EdgeBuilder.h"
+
+
+// The maximum distance, in device pixels, between a curve and the line
+// segments it is flattened into before it is stroked.
+static const float kStrokeFlattenTolerance = 0.25f;
+
+
+static float dot(GVector a, GVector b) {
+    return a.fX * b.fX + a.fY * b.fY;
+}
+
+
+static float cross(GVector a, GVector b) {
+    return a.fX * b.fY - a.fY * b.fX;
+}
+
+
+/**
+ * Rotate a vector by a quarter turn. If the vector is a segment's direction,
+ * the result points to the segment's left in a y-up coordinate system.
+ */
+static GVector perp(GVector v) {
+    return { -v.fY, v.fX };
+}
+
+
+/**
+ * One side of a stroke, built from the contour's first point to its last.
+ * Sides are recorded rather than written straight to the path so that the
+ * second side can be appended in reverse, making each stroke a single
+ * contour.
+ */
+class StrokeSide {
+public:
+    void moveTo(GPoint p) {
+        this->fStart = p;
+        this->fLast = p;
+        this->fPieces.clear();
+    }
+
+    void lineTo(GPoint p) {
+        if (p != this->fLast) {
+            this->fPieces.push_back({ false, { p, p, p } });
+            this->fLast = p;
+        }
+    }
+
+    void cubicTo(GPoint c1, GPoint c2, GPoint p) {
+        this->fPieces.push_back({ true, { c1, c2, p } });
+        this->fLast = p;
+    }
+
+    GPoint start() const { return this->fStart; }
+    GPoint last() const { return this->fLast; }
+
+    /**
+     * Append the side to a path as a new contour.
+     */
+    void addTo(GPath* path) const {
+        path->moveTo(this->fStart);
+        for (const Piece& piece : this->fPieces) {
+            if (piece.fCubic) {
+                path->cubicTo(piece.fPts[0], piece.fPts[1], piece.fPts[2]);
+            } else {
+                path->lineTo(piece.fPts[2]);
+            }
+        }
+    }
+
+    /**
+     * Append the side to a path backwards, from its last point to its start,
+     * continuing the path's current contour from the side's last point.
+     */
+    void addReversedTo(GPath* path) const {
+        for (size_t i = this->fPieces.size(); i > 0; --i) {
+            const Piece& piece = this->fPieces[i - 1];
+            GPoint prev = i > 1 ? this->fPieces[i - 2].fPts[2] : this->fStart;
+
+            if (piece.fCubic) {
+                path->cubicTo(piece.fPts[1], piece.fPts[0], prev);
+            } else {
+                path->lineTo(prev);
+            }
+        }
+    }
+
+private:
+    struct Piece {
+        bool   fCubic;
+        GPoint fPts[3];     // the control points of a cubic, then the end point
+    };
+
+    GPoint fStart;
+    GPoint fLast;
+    std::vector<Piece> fPieces;
+};
+
+
+/**
+ * Add a cubic approximating an arc of a circle from center + from to
+ * center + to. A cubic approximates an arc of angle a when its control points
+ * are 4/3 tan(a/4) times the radius along the tangents at its ends.
+ *
+ * Args:
+ *     k:
+ *         4/3 tan(a/4), negated if the arc turns clockwise in a y-up
+ *         coordinate system.
+ */
+template <typename Sink> static void arcCubicTo(
+        Sink& sink, GPoint center, GVector from, GVector to, float k) {
+    sink.cubicTo(center + from + perp(from) * k, center + to - perp(to) * k, center + to);
+}
+
+
+/**
+ * Add an arc of a circle, going the short way around from center + from to
+ * center + to. Arcs of up to a quarter turn are drawn as a single cubic;
+ * longer arcs are split in half first.
+ *
+ * Args:
+ *     sink:
+ *         The path or stroke side to add the arc to. Its current point must
+ *         be center + from.
+ *     center:
+ *         The center of the circle.
+ *     from, to:
+ *         The vectors from the center to the ends of the arc. Both must have
+ *         length radius, and they must not point in opposite directions.
+ *     radius:
+ *         The radius of the circle.
+ */
+template <typename Sink> static void arcTo(
+        Sink& sink, GPoint center, GVector from, GVector to, float radius) {
+    // tan(a/2) for the arc's angle a comes from the half angle formula, and
+    // applying it again with sec(a/2) gives tan(a/4).
+    float r2 = radius * radius;
+    float sinA = cross(from, to) / r2;
+    float cosA = dot(from, to) / r2;
+    float tanHalf = fabsf(sinA) / (1 + cosA);
+    float secHalf = sqrtf(1 + tanHalf * tanHalf);
+    float tanQuarter = tanHalf / (1 + secHalf);
+
+    // Point the tangents along the direction of travel.
+    float sign = sinA < 0 ? -1 : 1;
+
+    if (cosA >= 0) {
+        arcCubicTo(sink, center, from, to, sign * 4.0f / 3 * tanQuarter);
+        return;
+    }
+
+    // Both halves turn through a/2, so they share one k, made from tan(a/8).
+    // The middle of the arc is 'from' turned through a/2, whose cosine and
+    // sine come from the same sec(a/2).
+    GVector mid = (from + perp(from) * (sign * tanHalf)) * (1 / secHalf);
+    float tanEighth = tanQuarter / (1 + sqrtf(1 + tanQuarter * tanQuarter));
+    float k = sign * 4.0f / 3 * tanEighth;
+
+    arcCubicTo(sink, center, from, mid, k);
+    arcCubicTo(sink, center, mid, to, k);
+}
+
+
+/**
+ * Add a cap to a path, going from p + normal to p - normal around the end of
+ * the stroke that lies in the direction of -perp(normal).
+ */
+static void addCap(GStroke::Cap cap, GPath* path, GPoint p, GVector normal, float radius) {
+    GVector forward = { normal.fY, -normal.fX };
+    GVector back = { -normal.fX, -normal.fY };
+
+    switch (cap) {
+        case GStroke::kButt_Cap:
+            path->lineTo(p + back);
+            break;
+        case GStroke::kRound_Cap:
+            arcTo(*path, p, normal, forward, radius);
+            arcTo(*path, p, forward, back, radius);
+            break;
+        case GStroke::kSquare_Cap:
+            path->lineTo(p + normal + forward);
+            path->lineTo(p + back + forward);
+            path->lineTo(p + back);
+            break;
+    }
+}
+
+
+/**
+ * Add a join where the segments with normals n0 and n1 meet at p. Both sides
+ * must end at p +/- n0, and are left at p +/- n1.
+ *
+ * The inner side of the turn is routed back through p itself, which keeps
+ * both sides of the stroke winding the same way however short the segments
+ * are compared to the width.
+ */
+static void addJoin(const GStroke& stroke, StrokeSide& left, StrokeSide& right,
+                    GPoint p, GVector n0, GVector n1, float radius) {
+    float turn = cross(n0, n1);
+    float align = dot(n0, n1);
+
+    // The segments continue in a straight line.
+    if (turn == 0 && align > 0) {
+        return;
+    }
+
+    // A turn to the left puts the right side on the outside. A segment that
+    // doubles back on itself turns around its left side.
+    bool leftOuter = turn <= 0;
+    StrokeSide& outer = leftOuter ? left : right;
+    StrokeSide& inner = leftOuter ? right : left;
+    GVector o0 = leftOuter ? n0 : GVector{ -n0.fX, -n0.fY };
+    GVector o1 = leftOuter ? n1 : GVector{ -n1.fX, -n1.fY };
+
+    inner.lineTo(p);
+    inner.lineTo(p - o1);
+
+    float r2 = radius * radius;
+    switch (stroke.join()) {
+        case GStroke::kBevel_Join:
+            break;
+        case GStroke::kMiter_Join: {
+            // The outer edges meet at o0 + o1 scaled by r^2 / (r^2 + o0.o1).
+            // The squared length of the miter over r^2 is then
+            // 2r^2 / (r^2 + o0.o1), which is compared to the limit without
+            // taking a square root.
+            float denom = r2 + dot(o0, o1);
+            float limit = stroke.miterLimit();
+            if (denom > 0 && 2 * r2 <= limit * limit * denom) {
+                outer.lineTo(p + (o0 + o1) * (r2 / denom));
+            }
+            break;
+        }
+        case GStroke::kRound_Join:
+            if (turn == 0) {
+                GVector forward = { o0.fY, -o0.fX };
+                arcTo(outer, p, o0, forward, radius);
+                arcTo(outer, p, forward, o1, radius);
+            } else {
+                arcTo(outer, p, o0, o1, radius);
+            }
+            break;
+    }
+
+    outer.lineTo(p + o1);
+}
+
+
+/**
+ * Add a dot for a contour whose segments all have zero length, as long as the
+ * cap gives it some area.
+ */
+static void addDot(GStroke::Cap cap, GPath* path, GPoint p, float radius) {
+    switch (cap) {
+        case GStroke::kButt_Cap:
+            break;
+        case GStroke::kRound_Cap:
+            path->addCircle(p, radius);
+            break;
+        case GStroke::kSquare_Cap:
+            path->addRect(GRect::MakeLTRB(p.fX - radius, p.fY - radius,
+                                          p.fX + radius, p.fY + radius));
+            break;
+    }
+}
+
+
+/**
+ * Scratch storage for stroking contours, kept across contours so that a path
+ * with many contours only allocates for the largest of them.
+ */
+struct StrokeScratch {
+    std::vector<GVector> normals;
+    StrokeSide left;
+    StrokeSide right;
+};
+
+
+/**
+ * Stroke one flattened contour.
+ *
+ * Args:
+ *     stroke:
+ *         The stroke parameters.
+ *     pts:
+ *         The points of the contour, with no two consecutive points equal.
+ *     hasSegments:
+ *         True if the contour had any segments before duplicate points were
+ *         removed, in which case a single point still gets a dot.
+ *     scratch:
+ *         Storage for the contour's normals and sides.
+ *     path:
+ *         The path to append the outline of the stroke to.
+ */
+static void strokeContour(const GStroke& stroke, const std::vector<GPoint>& pts,
+                          bool hasSegments, StrokeScratch& scratch, GPath* path) {
+    float radius = stroke.width() / 2;
+
+    if (pts.size() == 1) {
+        if (hasSegments) {
+            addDot(stroke.cap(), path, pts[0], radius);
+        }
+        return;
+    }
+
+    // Each segment's normal is the only place a square root is needed.
+    size_t segCount = pts.size() - 1;
+    std::vector<GVector>& normals = scratch.normals;
+    normals.resize(segCount);
+    for (size_t i = 0; i < segCount; ++i) {
+        GVector d = pts[i + 1] - pts[i];
+        normals[i] = perp(d) * (radius / d.length());
+    }
+
+    bool closed = segCount > 1 && pts.front() == pts.back();
+
+    StrokeSide& left = scratch.left;
+    StrokeSide& right = scratch.right;
+    left.moveTo(pts[0] + normals[0]);
+    right.moveTo(pts[0] - normals[0]);
+
+    for (size_t i = 0; i < segCount; ++i) {
+        left.lineTo(pts[i + 1] + normals[i]);
+        right.lineTo(pts[i + 1] - normals[i]);
+
+        if (i + 1 < segCount) {
+            addJoin(stroke, left, right, pts[i + 1], normals[i], normals[i + 1], radius);
+        } else if (closed) {
+            addJoin(stroke, left, right, pts[0], normals[i], normals[0], radius);
+        }
+    }
+
+    // Each side has a point for every point of the contour, plus those added
+    // by joins and caps.
+    path->reserve(2 * pts.size() + 8, 2 * pts.size() + 8);
+
+    if (closed) {
+        left.addTo(path);
+        path->moveTo(right.last());
+        right.addReversedTo(path);
+        return;
+    }
+
+    left.addTo(path);
+    addCap(stroke.cap(), path, pts.back(), normals.back(), radius);
+    right.addReversedTo(path);
+
+    GVector startNormal = { -normals[0].fX, -normals[0].fY };
+    addCap(stroke.cap(), path, pts[0], startNormal, radius);
+}
+
+
+/**
+ * Append points to a contour, skipping any that repeat the previous point.
+ */
+static void appendPoints(std::vector<GPoint>& contour, const GPoint pts[], int count) {
+    for (int i = 0; i < count; ++i) {
+        if (contour.empty() || contour.back() != pts[i]) {
+            contour.push_back(pts[i]);
+        }
+    }
+}
+
+
+void GStroke::strokePath(const GPath& src, GPath* dst, float scale) const {
+    if (!(this->fWidth > 0)) {
+        return;
+    }
+
+    // Flatten curves to the tolerance in device pixels, measured in path
+    // units.
+    float tolerance = scale > 0 ? kStrokeFlattenTolerance / scale : kStrokeFlattenTolerance;
+
+    std::vector<GPoint> contour;
+    std::vector<GPoint> flattened;
+    StrokeScratch scratch;
+    bool hasSegments = false;
+
+    GPath::Iter iter(src);
+    GPoint pts[4];
+    GPath::Verb verb;
+
+    while ((verb = iter.next(pts)) != GPath::kDone) {
+        switch (verb) {
+            case GPath::kMove:
+                if (!contour.empty()) {
+                    strokeContour(*this, contour, hasSegments, scratch, dst);
+                }
+                contour.clear();
+                contour.push_back(pts[0]);
+                hasSegments = false;
+                break;
+            case GPath::kLine:
+                appendPoints(contour, &pts[1], 1);
+                hasSegments = true;
+                break;
+            case GPath::kQuad:
+            case GPath::kCubic:
+                flattened.clear();
+                flattenCurve(pts, verb == GPath::kQuad ? 3 : 4, tolerance, flattened);
+                appendPoints(contour, flattened.data(), (int) flattened.size());
+                hasSegments = true;
+                break;
+            default:
+                break;
+        }
+    }
+
+    if (!contour.empty()) {
+        strokeContour(*this, contour, hasSegments, scratch, dst);
+    }
+}
@@ -0,0 +1,79 @@
+#include "GColor.h"
+#include "GMatrix.h"
+#include "GPixel.h"
+#include "GPoint.h"
+#include "GTriangleGradient.h"
+
+#include "SIMD.h"
+
+
+/**
+ * Pack a color into (a, r, g, b) lanes.
+ */
+static Float4 colorToFloat4(const GColor& color) {
+    GColor pinned = color.pinToUnit();
+
+    return Float4{ pinned.fA, pinned.fR, pinned.fG, pinned.fB };
+}
+
+
+GTriangleGradient::GTriangleGradient(const GPoint pts[3], const GColor colors[3]) {
+    GVector u = pts[1] - pts[0];
+    GVector v = pts[2] - pts[0];
+
+    fUnitMatrix.set6(
+        u.fX, v.fX, pts[0].fX,
+        u.fY, v.fY, pts[0].fY);
+
+    fColor0 = colorToFloat4(colors[0]);
+    fDeltaU = colorToFloat4(colors[1]) - fColor0;
+    fDeltaV = colorToFloat4(colors[2]) - fColor0;
+
+    fOpaque = fColor0[0] == 1 && fDeltaU[0] == 0 && fDeltaV[0] == 0;
+}
+
+
+bool GTriangleGradient::isOpaque() {
+    return fOpaque;
+}
+
+
+bool GTriangleGradient::setContext(const GMatrix& ctm) {
+    GMatrix matrix;
+    matrix.setConcat(ctm, fUnitMatrix);
+
+    if (!matrix.invert(&fLocalMatrix)) {
+        return false;
+    }
+
+    // Moving one pixel along a row moves (u, v) by the matrix's first column,
+    // which changes the color by a constant amount.
+    fStepX = Float4_Splat(fLocalMatrix[GMatrix::SX]) * fDeltaU
+           + Float4_Splat(fLocalMatrix[GMatrix::KY]) * fDeltaV;
+
+    return true;
+}
+
+
+void GTriangleGradient::shadeRow(int x, int y, int count, GPixel row[]) {
+    GPoint uv = fLocalMatrix.mapXY(x, y);
+    Float4 color = fColor0 + Float4_Splat(uv.fX) * fDeltaU + Float4_Splat(uv.fY) * fDeltaV;
+
+    const Float4 zero = Float4_Splat(0);
+    const Float4 one = Float4_Splat(1);
+    const Float4 scale = Float4_Splat(255);
+    const Float4 half = Float4_Splat(0.5f);
+
+    for (int i = 0; i < count; ++i) {
+        // Pixels just outside the triangle extrapolate past the corner colors.
+        Float4 c = Float4_Max(zero, Float4_Min(one, color));
+
+        // Premultiply every channel but alpha by alpha. The channels are
+        // never negative, so truncating rounds them the same as flooring.
+        Float4 premul = c * Float4{ 1, c[0], c[0], c[0] };
+        Int4 value = __builtin_convertvector(premul * scale + half, Int4);
+
+        row[i] = GPixel_PackARGB(value[0], value[1], value[2], value[3]);
+        color += fStepX;
+    }
+}
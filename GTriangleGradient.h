@@ -0,0 +1,46 @@
+#ifndef GTriangleGradient_DEFINED
+#define GTriangleGradient_DEFINED
+
+
+#include "GColor.h"
+#include "GMatrix.h"
+#include "GPixel.h"
+#include "GPoint.h"
+#include "GShader.h"
+
+#include "SIMD.h"
+
+
+/**
+ * Shader that linearly interpolates the colors at the three corners of a
+ * triangle across the plane, like the vertex colors of a mesh.
+ */
+class GTriangleGradient : public GShader {
+public:
+    GTriangleGradient(const GPoint pts[3], const GColor colors[3]);
+
+    bool isOpaque() override;
+    bool setContext(const GMatrix& ctm) override;
+    void shadeRow(int x, int y, int count, GPixel row[]) override;
+
+private:
+    // Maps the unit triangle (0, 0), (1, 0), (0, 1) onto the triangle.
+    GMatrix fUnitMatrix;
+
+    // Maps device space onto the unit triangle, where the color is
+    // c0 + u * (c1 - c0) + v * (c2 - c0).
+    GMatrix fLocalMatrix;
+
+    // Colors are stored as (a, r, g, b) lanes, unpremultiplied.
+    Float4 fColor0;
+    Float4 fDeltaU;
+    Float4 fDeltaV;
+
+    // The change in color from one pixel to the next along a row.
+    Float4 fStepX;
+
+    bool fOpaque;
+};
+
+
+#endif
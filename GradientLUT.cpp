@@ -0,0 +1,39 @@
+#include "GColor.h"
+#include "GPixel.h"
+
+#include "ColorUtils.h"
+#include "GradientLUT.h"
+
+
+GradientLUT::GradientLUT(const GColor colors[], int count) {
+    GASSERT(count >= 1);
+
+    if (count == 1) {
+        GPixel pixel = colorToPixel(colors[0].pinToUnit());
+        for (int i = 0; i < kSize; ++i) {
+            this->fTable[i] = pixel;
+        }
+        return;
+    }
+
+    int spans = count - 1;
+    for (int i = 0; i < kSize; ++i) {
+        float t = (float) i / (kSize - 1);
+
+        // Find the pair of colors this entry lies between, and how far along
+        // from the first to the second it is.
+        int index = std::min(spans - 1, (int) (t * spans));
+        float u = t * spans - index;
+
+        GColor c1 = colors[index].pinToUnit();
+        GColor c2 = colors[index + 1].pinToUnit();
+
+        GColor color = GColor::MakeARGB(
+            c1.fA * (1 - u) + c2.fA * u,
+            c1.fR * (1 - u) + c2.fR * u,
+            c1.fG * (1 - u) + c2.fG * u,
+            c1.fB * (1 - u) + c2.fB * u);
+
+        this->fTable[i] = colorToPixel(color.pinToUnit());
+    }
+}
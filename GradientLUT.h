@@ -0,0 +1,104 @@
+#ifndef GradientLUT_DEFINED
+#define GradientLUT_DEFINED
+
+#include <algorithm>
+#include <math.h>
+
+#include "GColor.h"
+#include "GPixel.h"
+#include "GShader.h"
+
+#include "SIMD.h"
+
+
+/**
+ * A table of the premultiplied pixels along a gradient. Colors are
+ * interpolated and converted once, when the table is built, so shading a
+ * pixel only takes a table lookup.
+ */
+class GradientLUT {
+public:
+    // The number of entries in the table. With more entries than there are
+    // 8-bit channel values, neighboring entries never differ by more than one
+    // step in any channel.
+    static const int kSize = 1024;
+
+    /**
+     * Build the table for a gradient.
+     *
+     * Args:
+     *     colors:
+     *         The colors of the gradient, evenly spaced from its start to its
+     *         end. Components outside of [0, 1] are pinned.
+     *     count:
+     *         The number of colors, which must be at least 1. A single color
+     *         makes a gradient of one solid color.
+     */
+    GradientLUT(const GColor colors[], int count);
+
+    /**
+     * Look up the pixel at a position along the gradient, where 0 is its start
+     * and 1 is its end.
+     */
+    GPixel lookup(float t) const {
+        GASSERT(0 <= t && t <= 1);
+
+        return fTable[(int) (t * (kSize - 1) + 0.5f)];
+    }
+
+    /**
+     * Look up the pixels at four positions along the gradient at once, each
+     * in the range [0, 1].
+     */
+    void lookup4(Float4 t, GPixel dst[4]) const {
+        Int4 index = Float4_FloorToInt(t * Float4_Splat(kSize - 1) + Float4_Splat(0.5f));
+
+        dst[0] = fTable[index[0]];
+        dst[1] = fTable[index[1]];
+        dst[2] = fTable[index[2]];
+        dst[3] = fTable[index[3]];
+    }
+
+private:
+    GPixel fTable[kSize];
+};
+
+
+/**
+ * Map a position along a gradient into the range [0, 1] according to how the
+ * gradient is tiled beyond its ends.
+ */
+static inline float tileUnit(float t, GShader::TileMode tile) {
+    if (tile == GShader::kRepeat) {
+        t = t - floorf(t);
+    } else if (tile == GShader::kMirror) {
+        t *= 0.5f;
+        t = t - floorf(t);
+        if (t > 0.5f) {
+            t = 1 - t;
+        }
+        t *= 2;
+    }
+
+    // Clamping also catches repeated positions that round up to 1.
+    return std::max(0.0f, std::min(1.0f, t));
+}
+
+
+/**
+ * Equivalent to tileUnit for each lane, without branching on the positions.
+ */
+static inline Float4 tileUnit4(Float4 t, GShader::TileMode tile) {
+    if (tile == GShader::kRepeat) {
+        t = t - Int4_ToFloat(Float4_FloorToInt(t));
+    } else if (tile == GShader::kMirror) {
+        t = t * Float4_Splat(0.5f);
+        t = t - Int4_ToFloat(Float4_FloorToInt(t));
+        t = Float4_Min(t, Float4_Splat(1) - t) * Float4_Splat(2);
+    }
+
+    return Float4_Max(Float4_Splat(0), Float4_Min(Float4_Splat(1), t));
+}
+
+
+#endif
@@ -0,0 +1,75 @@
+#include <algorithm>
+
+#include "GBitmap.h"
+#include "GPixel.h"
+
+#include "Mipmap.h"
+
+
+/**
+ * Average four premultiplied pixels, rounding to the nearest value.
+ *
+ * The alpha and green channels are added in one 32-bit word and the red and
+ * blue channels in another, with each channel given 16 bits so that the sum
+ * of four never carries into its neighbor.
+ */
+static inline GPixel averagePixels(GPixel a, GPixel b, GPixel c, GPixel d) {
+    const uint32_t mask = 0x00FF00FF;
+
+    uint32_t evens = (a & mask) + (b & mask) + (c & mask) + (d & mask) + 0x00020002;
+    uint32_t odds = ((a >> 8) & mask) + ((b >> 8) & mask) + ((c >> 8) & mask) + ((d >> 8) & mask)
+        + 0x00020002;
+
+    return ((evens >> 2) & mask) | (((odds >> 2) & mask) << 8);
+}
+
+
+/**
+ * Fill a level from the one above it. Odd rows and columns at the far edge of
+ * the source are averaged with themselves rather than dropped into the next
+ * block, so every source texel contributes.
+ */
+static void downsample(const GBitmap& src, const GBitmap& dst) {
+    for (int y = 0; y < dst.height(); ++y) {
+        const GPixel* row0 = src.getAddr(0, std::min(2 * y, src.height() - 1));
+        const GPixel* row1 = src.getAddr(0, std::min(2 * y + 1, src.height() - 1));
+        GPixel* out = dst.getAddr(0, y);
+
+        for (int x = 0; x < dst.width(); ++x) {
+            int x0 = std::min(2 * x, src.width() - 1);
+            int x1 = std::min(2 * x + 1, src.width() - 1);
+
+            out[x] = averagePixels(row0[x0], row0[x1], row1[x0], row1[x1]);
+        }
+    }
+}
+
+
+Mipmap::Mipmap(const GBitmap& base) {
+    this->fLevels.push_back(base);
+
+    while (this->fLevels.back().width() > 1 || this->fLevels.back().height() > 1) {
+        const GBitmap& prev = this->fLevels.back();
+        int width = std::max(1, prev.width() / 2);
+        int height = std::max(1, prev.height() / 2);
+
+        this->fStorage.emplace_back(width * height);
+        GBitmap level(width, height, width * sizeof(GPixel), this->fStorage.back().data(), false);
+
+        // Averages of opaque texels are opaque.
+        downsample(prev, level);
+        level.setIsOpaque(base.isOpaque() ? GBitmap::kYes_IsOpaque : GBitmap::kNo_IsOpaque);
+        this->fLevels.push_back(level);
+    }
+}
+
+
+int Mipmap::levelFor(float texelsPerPixel) const {
+    int level = 0;
+    while (level + 1 < this->levelCount() && texelsPerPixel >= 2) {
+        texelsPerPixel *= 0.5f;
+        level++;
+    }
+
+    return level;
+}
@@ -0,0 +1,47 @@
+#ifndef Mipmap_DEFINED
+#define Mipmap_DEFINED
+
+#include <vector>
+
+#include "GBitmap.h"
+#include "GPixel.h"
+
+
+/**
+ * A chain of successively halved copies of a bitmap, each texel of a level
+ * being the average of the 2x2 block of texels below it. Drawing a bitmap at
+ * a small scale from the matching level reads texels that are close together
+ * in memory, and each one already stands for the texels it covers.
+ */
+class Mipmap {
+public:
+    /**
+     * Build every level of the chain, down to a single texel, from a bitmap's
+     * current pixels. Level 0 is the bitmap itself and is not copied.
+     */
+    explicit Mipmap(const GBitmap& base);
+
+    int levelCount() const { return (int) this->fLevels.size(); }
+
+    const GBitmap& level(int index) const { return this->fLevels[index]; }
+
+    /**
+     * Choose the level to sample for a given minification.
+     *
+     * Args:
+     *     texelsPerPixel:
+     *         How many texels of the base bitmap one device pixel spans, in
+     *         the direction it spans the most.
+     *
+     * Returns:
+     *     The deepest level whose texels are no larger than a pixel.
+     */
+    int levelFor(float texelsPerPixel) const;
+
+private:
+    std::vector<GBitmap> fLevels;
+    std::vector<std::vector<GPixel>> fStorage;
+};
+
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef SIMD_DEFINED
+#define SIMD_DEFINED
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+#if defined(__SSE__)
+#include <xmmintrin.h>
+#endif
+
+
+/**
+ * Four-wide vectors of floats and ints. These use the compiler's vector
+ * extensions, so arithmetic and comparison operators work lane by lane and
+ * compile down to SSE/NEON instructions where they are available.
+ *
+ * Comparisons produce an Int4 where each lane is -1 (all bits set) if the
+ * comparison was true, and 0 otherwise.
+ */
+typedef float Float4 __attribute__((vector_size(16)));
+typedef int32_t Int4 __attribute__((vector_size(16)));
+
+
+/**
+ * The channels of two pixels, widened to 16 bits each so that they can be
+ * multiplied by 8-bit weights without overflowing.
+ */
+typedef uint8_t U8x8 __attribute__((vector_size(8)));
+typedef uint16_t U16x8 __attribute__((vector_size(16)));
+
+
+/**
+ * Create a vector with every lane set to the same value.
+ */
+static inline Float4 Float4_Splat(float value) {
+    return Float4{ value, value, value, value };
+}
+
+
+static inline Int4 Int4_Splat(int32_t value) {
+    return Int4{ value, value, value, value };
+}
+
+
+/**
+ * Pick lanes from 'a' where the mask is set, and from 'b' everywhere else.
+ */
+static inline Float4 Float4_Select(Int4 mask, Float4 a, Float4 b) {
+    return mask ? a : b;
+}
+
+
+static inline Int4 Int4_Select(Int4 mask, Int4 a, Int4 b) {
+    return mask ? a : b;
+}
+
+
+static inline Float4 Float4_Min(Float4 a, Float4 b) {
+    return a < b ? a : b;
+}
+
+
+static inline Float4 Float4_Max(Float4 a, Float4 b) {
+    return a > b ? a : b;
+}
+
+
+/**
+ * Round each lane towards negative infinity.
+ */
+static inline Int4 Float4_FloorToInt(Float4 value) {
+    Int4 truncated = __builtin_convertvector(value, Int4);
+
+    // Truncation rounds negative numbers up, so step those lanes back down.
+    // The comparison is -1 in lanes where that happened.
+    return truncated + (__builtin_convertvector(truncated, Float4) > value);
+}
+
+
+/**
+ * Equivalent to GRoundToInt for each lane.
+ */
+static inline Int4 Float4_RoundToInt(Float4 value) {
+    return Float4_FloorToInt(value + Float4_Splat(0.5f));
+}
+
+
+/**
+ * Take the square root of each lane, with a single instruction where the
+ * target has one.
+ */
+static inline Float4 Float4_Sqrt(Float4 value) {
+#if defined(__SSE__)
+    return (Float4) _mm_sqrt_ps((__m128) value);
+#else
+    return Float4{ sqrtf(value[0]), sqrtf(value[1]), sqrtf(value[2]), sqrtf(value[3]) };
+#endif
+}
+
+
+static inline Float4 Int4_ToFloat(Int4 value) {
+    return __builtin_convertvector(value, Float4);
+}
+
+
+
+/**
+ * Widen the channels of two pixels, with the first pixel in the low lanes.
+ */
+static inline U16x8 U16x8_Expand(uint32_t a, uint32_t b) {
+    uint64_t bits = a | (uint64_t) b << 32;
+
+    U8x8 bytes;
+    memcpy(&bytes, &bits, sizeof(bytes));
+    return __builtin_convertvector(bytes, U16x8);
+}
+
+
+/**
+ * Narrow the channels of two pixels back to 8 bits, storing them in dst[0]
+ * and dst[1]. Every lane must already fit in 8 bits.
+ */
+static inline void U16x8_Pack(U16x8 value, uint32_t dst[2]) {
+    U8x8 bytes = __builtin_convertvector(value, U8x8);
+    memcpy(dst, &bytes, sizeof(bytes));
+}
+
+
+#endif
@@ -0,0 +1,35 @@
+#include <stdint.h>
+
+#include "GBitmap.h"
+#include "GPixel.h"
+
+#include "SwizzledBitmap.h"
+
+
+// Tiles line up with cache lines when the first one starts on a line.
+static const int kCacheLineSize = 64;
+
+
+SwizzledBitmap::SwizzledBitmap(const GBitmap& source) {
+    const int tileSize = 1 << kTileShift;
+    this->fTilesPerRow = (source.width() + tileSize - 1) >> kTileShift;
+    int tileRows = (source.height() + tileSize - 1) >> kTileShift;
+
+    // Leave room to move the tiles up to the next cache line.
+    const int padding = kCacheLineSize / sizeof(GPixel) - 1;
+    this->fStorage.resize(this->fTilesPerRow * tileRows * tileSize * tileSize + padding);
+
+    uintptr_t addr = reinterpret_cast<uintptr_t>(this->fStorage.data());
+    uintptr_t aligned = (addr + kCacheLineSize - 1) & ~(uintptr_t) (kCacheLineSize - 1);
+    GPixel* pixels = reinterpret_cast<GPixel*>(aligned);
+    this->fPixels = pixels;
+
+    // Texels past the right and bottom edges of the bitmap are never read,
+    // and are left as they were allocated.
+    for (int y = 0; y < source.height(); ++y) {
+        const GPixel* src = source.getAddr(0, y);
+        for (int x = 0; x < source.width(); ++x) {
+            pixels[this->offset(x, y)] = src[x];
+        }
+    }
+}
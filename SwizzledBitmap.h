@@ -0,0 +1,71 @@
+#ifndef SwizzledBitmap_DEFINED
+#define SwizzledBitmap_DEFINED
+
+#include <vector>
+
+#include "GBitmap.h"
+#include "GPixel.h"
+
+#include "SIMD.h"
+
+
+/**
+ * Finds texels in a bitmap stored the usual way, one row after another.
+ */
+class RowMajorTexels {
+public:
+    explicit RowMajorTexels(const GBitmap& bitmap)
+        : fPixels(bitmap.pixels())
+        , fStride((int) (bitmap.rowBytes() >> 2)) {}
+
+    const GPixel* pixels() const { return this->fPixels; }
+
+    int offset(int x, int y) const { return y * this->fStride + x; }
+
+    Int4 offset4(Int4 x, Int4 y) const { return y * Int4_Splat(this->fStride) + x; }
+
+private:
+    const GPixel* fPixels;
+    int fStride;
+};
+
+
+/**
+ * A copy of a bitmap stored as 4x4 tiles of texels, with the tiles in row
+ * major order and each tile taking up one 64-byte cache line.
+ *
+ * Sampling a bitmap at an angle walks across its rows, so a row major bitmap
+ * needs a new cache line for nearly every texel. In the tiled copy, a step in
+ * any direction usually stays within the same tile.
+ */
+class SwizzledBitmap {
+public:
+    /**
+     * Copy a bitmap's current pixels into tiles.
+     */
+    explicit SwizzledBitmap(const GBitmap& source);
+
+    const GPixel* pixels() const { return this->fPixels; }
+
+    int offset(int x, int y) const {
+        return (((y >> kTileShift) * this->fTilesPerRow + (x >> kTileShift)) << (2 * kTileShift))
+            + ((y & kTileMask) << kTileShift) + (x & kTileMask);
+    }
+
+    Int4 offset4(Int4 x, Int4 y) const {
+        Int4 tile = (y >> kTileShift) * Int4_Splat(this->fTilesPerRow) + (x >> kTileShift);
+        Int4 mask = Int4_Splat(kTileMask);
+        return (tile << (2 * kTileShift)) + ((y & mask) << kTileShift) + (x & mask);
+    }
+
+private:
+    static const int kTileShift = 2;
+    static const int kTileMask = (1 << kTileShift) - 1;
+
+    const GPixel* fPixels;
+    int fTilesPerRow;
+    std::vector<GPixel> fStorage;
+};
+
+
+#endif
@@ -16,6 +16,10 @@ public:
     void save() override { if (fProxy) fProxy->save(); }
     void restore() override { if (fProxy) fProxy->restore(); }
     void concat(const GMatrix& m) override { if (fProxy) fProxy->concat(m); }
+    void clipPath(const GPath& p) override { if (fProxy) fProxy->clipPath(p); }
+    void clipRect(const GRect& r, ClipOp op) override { if (fProxy) fProxy->clipRect(r, op); }
+    void clipRegion(const GRegion& r) override { if (fProxy) fProxy->clipRegion(r); }
+    bool quickReject(const GRect& r) override { return fProxy ? fProxy->quickReject(r) : false; }
 
     void drawPaint(const GPaint& p) override {
         if (this->allowDraw()) {
@@ -41,6 +45,12 @@ public:
         }
     }
 
+    void drawStrokedPath(const GPath& path, const GStroke& stroke, const GPaint& paint) override {
+        if (this->allowDraw()) {
+            fProxy->drawStrokedPath(path, stroke, paint);
+        }
+    }
+
 protected:
     void onSaveLayer(const GRect* bounds, const GPaint& paint) override {
         if (fProxy) { fProxy->saveLayer(bounds, paint); }
@@ -6,8 +6,11 @@
 #include "GCanvas.h"
 #include "GBitmap.h"
 #include "GColor.h"
+#include "GPath.h"
 #include "GRandom.h"
 #include "GRect.h"
+#include "GShader.h"
+#include "GStroke.h"
 #include <string>
 
 static GColor rand_color(GRandom& rand, bool forceOpaque = false) {
@@ -127,6 +130,203 @@ public:
     }
 };
 
+class PathCirclesBench : public GBenchmark {
+    enum { W = 200, H = 200 };
+    const bool fTiny;
+public:
+    PathCirclesBench(bool tiny) : fTiny(tiny) {}
+
+    const char* name() const override { return fTiny ? "path_circles_tiny" : "path_circles_large"; }
+    GISize size() const override { return { W, H }; }
+    void draw(GCanvas* canvas) override {
+        const float rad = fTiny ? 5 : 90;
+
+        const int N = 500;
+        GRandom rand;
+        for (int i = 0; i < N; ++i) {
+            GPath path;
+            path.addCircle({ rand.nextF() * W, rand.nextF() * H }, rad);
+            canvas->drawPath(path, GPaint(rand_color(rand, true)));
+        }
+    }
+};
+
+class StrokeBench : public GBenchmark {
+    enum { W = 200, H = 200 };
+    const float fWidth;
+    const GStroke::Join fJoin;
+    const char* fName;
+    GPath fPath;
+public:
+    StrokeBench(float width, GStroke::Join join, const char* name)
+        : fWidth(width), fJoin(join), fName(name) {
+        // A random walk, like a plot with far more samples than pixels.
+        const int N = 5000;
+        GRandom rand;
+        GPoint p = { W / 2, H / 2 };
+        fPath.moveTo(p);
+        for (int i = 0; i < N; ++i) {
+            p.fX = std::max(0.0f, std::min((float)W, p.fX + (rand.nextF() - 0.5f) * 8));
+            p.fY = std::max(0.0f, std::min((float)H, p.fY + (rand.nextF() - 0.5f) * 8));
+            fPath.lineTo(p);
+        }
+    }
+
+    const char* name() const override { return fName; }
+    GISize size() const override { return { W, H }; }
+    void draw(GCanvas* canvas) override {
+        GStroke stroke(fWidth, fJoin, GStroke::kRound_Cap);
+        canvas->drawStrokedPath(fPath, stroke, GPaint({ 1, 0, 0, 0 }));
+    }
+};
+
+// The scene from final_radial in image_final.cpp.
+class RadialBench : public GBenchmark {
+    enum { W = 512, H = 512 };
+public:
+    const char* name() const override { return "final_radial"; }
+    GISize size() const override { return { W, H }; }
+    void draw(GCanvas* canvas) override {
+        const GColor c0[] = {
+            {1,0,0,0}, {1, 0, 0.75, 0}, {0,1,1,0},
+        };
+        this->drawRect(canvas, GRect::MakeLTRB(0, 0, 512, 512), c0, GARRAY_COUNT(c0));
+        const GColor c1[] = {
+            {1,1,0,0}, {1, 0, 1, 0}, {1,0,0,1}, {1,1,0,0},
+        };
+        this->drawRect(canvas, GRect::MakeLTRB(-150, -150, 150, 150), c1, GARRAY_COUNT(c1));
+    }
+
+private:
+    void drawRect(GCanvas* canvas, const GRect& r, const GColor colors[], int count) {
+        float rad = (r.width() / 2) * sqrt(2);
+        auto sh = canvas->final_createRadialGradient({r.centerX(), r.centerY()}, rad, colors, count);
+        canvas->drawRect(r, GPaint(sh.get()));
+    }
+};
+
+// The scenes from spock_clock in image_pa3.cpp and bitmap_tiling in image_pa6.cpp, drawn with a
+// generated bitmap so that they don't depend on an image file.
+class BitmapBench : public GBenchmark {
+    enum { W = 512, H = 512 };
+    const bool fTiling;
+    const GShader::FilterQuality fQuality;
+    const char* fName;
+    GBitmap fBM;
+public:
+    BitmapBench(bool tiling, GShader::FilterQuality quality, const char* name)
+        : fTiling(tiling), fQuality(quality), fName(name)
+    {
+        fBM.alloc(256, 256);
+        for (int y = 0; y < fBM.height(); ++y) {
+            for (int x = 0; x < fBM.width(); ++x) {
+                int check = ((x >> 4) ^ (y >> 4)) & 1 ? 0xFF : 0x40;
+                *fBM.getAddr(x, y) = GPixel_PackARGB(0xFF, check, x, y);
+            }
+        }
+    }
+    ~BitmapBench() override { free(fBM.pixels()); }
+
+    const char* name() const override { return fName; }
+    GISize size() const override { return { W, H }; }
+    void draw(GCanvas* canvas) override {
+        if (fTiling) {
+            const GMatrix m = GMatrix().postRotate(-M_PI/6).postScale(4, 4);
+            auto sh = GCreateBitmapShader(fBM, m, GShader::kRepeat, fQuality);
+            canvas->drawRect(GRect::MakeXYWH(0, 0, 512, 250), GPaint(sh.get()));
+            sh = GCreateBitmapShader(fBM, m, GShader::kMirror, fQuality);
+            canvas->drawRect(GRect::MakeXYWH(0, 262, 512, 250), GPaint(sh.get()));
+            return;
+        }
+
+        float cx = fBM.width() * 0.5f;
+        float cy = fBM.height() * 0.5f;
+        GPoint pts[] = {
+            { cx, 0 }, { 0, cy }, { cx, fBM.height()*1.0f }, { fBM.width()*1.0f, cy },
+        };
+
+        auto sh = GCreateBitmapShader(fBM, GMatrix(), GShader::kClamp, fQuality);
+        GPaint paint(sh.get());
+
+        const int n = 7;
+        canvas->save();
+        canvas->translate(256 - cx*3, 256 - cx*3);
+        for (int i = 0; i < n; ++i) {
+            canvas->save();
+            canvas->translate(cx*3, cx*3);
+            canvas->rotate(i * M_PI * 2 / n);
+            canvas->translate(cx, -cy);
+            canvas->drawConvexPolygon(pts, 4, paint);
+            canvas->restore();
+        }
+        canvas->restore();
+    }
+};
+
+// A grid of thumbnails of one large bitmap, all drawn with the same shader.
+class ThumbnailBench : public GBenchmark {
+    enum { W = 512, H = 512 };
+    GBitmap fBM;
+    std::unique_ptr<GShader> fShader;
+public:
+    ThumbnailBench() {
+        fBM.alloc(2048, 2048);
+        GRandom rand;
+        for (int y = 0; y < fBM.height(); ++y) {
+            for (int x = 0; x < fBM.width(); ++x) {
+                *fBM.getAddr(x, y) = GPixel_PackARGB(0xFF, x >> 3, y >> 3, rand.nextU() & 0xFF);
+            }
+        }
+        fShader = GCreateBitmapShader(fBM, GMatrix());
+    }
+    ~ThumbnailBench() override { free(fBM.pixels()); }
+
+    const char* name() const override { return "bitmap_thumbnails"; }
+    GISize size() const override { return { W, H }; }
+    void draw(GCanvas* canvas) override {
+        GPaint paint(fShader.get());
+        const float scale = 1.0f / 16;
+        for (int y = 0; y < H; y += 128) {
+            for (int x = 0; x < W; x += 128) {
+                canvas->save();
+                canvas->translate(x, y);
+                canvas->scale(scale, scale);
+                canvas->drawRect(GRect::MakeWH(fBM.width(), fBM.height()), paint);
+                canvas->restore();
+            }
+        }
+    }
+};
+
+// Bitmaps drawn at whole-pixel offsets, as a compositor draws its layers.
+class SpriteBench : public GBenchmark {
+    enum { W = 512, H = 512 };
+    GBitmap fBM;
+public:
+    SpriteBench() {
+        fBM.alloc(128, 128);
+        for (int y = 0; y < fBM.height(); ++y) {
+            for (int x = 0; x < fBM.width(); ++x) {
+                *fBM.getAddr(x, y) = GPixel_PackARGB(0xFF, x * 2, y * 2, 0x80);
+            }
+        }
+    }
+    ~SpriteBench() override { free(fBM.pixels()); }
+
+    const char* name() const override { return "bitmap_sprites"; }
+    GISize size() const override { return { W, H }; }
+    void draw(GCanvas* canvas) override {
+        GRandom rand;
+        for (int i = 0; i < 200; ++i) {
+            float x = (int) (rand.nextF() * (W - 64));
+            float y = (int) (rand.nextF() * (H - 64));
+            auto sh = GCreateBitmapShader(fBM, GMatrix::MakeTranslate(-x, -y));
+            canvas->drawRect(GRect::MakeXYWH(x, y, fBM.width(), fBM.height()),
+                             GPaint(sh.get()));
+        }
+    }
+};
+
 class ModesBench : public GBenchmark {
     enum { W = 200, H = 200 };
     const GColor fColor;
@@ -166,6 +366,18 @@ const GBenchmark::Factory gBenchFactories[] {
     []() -> GBenchmark* { return new PolyRectsBench(true);  },
     []() -> GBenchmark* { return new CirclesBench(false); },
     []() -> GBenchmark* { return new CirclesBench(true);  },
+    []() -> GBenchmark* { return new PathCirclesBench(false); },
+    []() -> GBenchmark* { return new PathCirclesBench(true);  },
+    []() -> GBenchmark* { return new StrokeBench(2, GStroke::kMiter_Join, "stroke_miter"); },
+    []() -> GBenchmark* { return new StrokeBench(2, GStroke::kRound_Join, "stroke_round"); },
+    []() -> GBenchmark* { return new StrokeBench(0, GStroke::kMiter_Join, "stroke_hairline"); },
+    []() -> GBenchmark* { return new RadialBench; },
+    []() -> GBenchmark* { return new BitmapBench(false, GShader::kNearest, "bitmap_clock"); },
+    []() -> GBenchmark* { return new BitmapBench(false, GShader::kBilinear, "bitmap_clock_bilerp"); },
+    []() -> GBenchmark* { return new BitmapBench(true, GShader::kNearest, "bitmap_tiling"); },
+    []() -> GBenchmark* { return new BitmapBench(true, GShader::kBilinear, "bitmap_tiling_bilerp"); },
+    []() -> GBenchmark* { return new ThumbnailBench; },
+    []() -> GBenchmark* { return new SpriteBench; },
     []() -> GBenchmark* { return new ModesBench({0.0, 1, 0.5, 0.25}, "modes_0"); },
     []() -> GBenchmark* { return new ModesBench({0.5, 1, 0.5, 0.25}, "modes_half"); },
     []() -> GBenchmark* { return new ModesBench({1.0, 1, 0.5, 0.25}, "modes_1"); },
@@ -7,9 +7,11 @@
 #include "GCanvas.h"
 #include "GColor.h"
 #include "GFilter.h"
+#include "GPath.h"
 #include "GRandom.h"
 #include "GRect.h"
 #include "GShader.h"
+#include "GStroke.h"
 
 #include <vector>
 
@@ -79,13 +81,9 @@ static void draw_point(GCanvas* canvas, GPoint p) {
 }
 
 static void draw_line(GCanvas* canvas, GPoint p0, GPoint p1, GColor c, float width) {
-    GVector norm = { p1.y() - p0.y(), p0.x() - p1.x() };
-    float scale = width / 2 / norm.length();
-    norm.fX *= scale;
-    norm.fY *= scale;
-
-    GPoint quad[4] = { p0 + norm, p1 + norm, p1 - norm, p0 - norm };
-    canvas->drawConvexPolygon(quad, 4, GPaint(c));
+    GPath path;
+    path.moveTo(p0).lineTo(p1);
+    canvas->drawStrokedPath(path, GStroke(width), GPaint(c));
 }
 
 
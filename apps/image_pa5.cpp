@@ -8,6 +8,7 @@
 #include "GColor.h"
 #include "GMatrix.h"
 #include "GPath.h"
+#include "GPathBuilder.h"
 #include "GPoint.h"
 #include "GRandom.h"
 #include "GRect.h"
@@ -85,6 +86,9 @@ static void stars(GCanvas* canvas) {
 }
 
 static void draw_lion_bare(GCanvas* canvas) {
+    // The lion's shapes are built into one arena rather than each on the heap.
+    GArena arena;
+    GPathBuilder builder(&arena);
 #include "lion.inc"
 }
 
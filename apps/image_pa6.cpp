@@ -8,6 +8,7 @@
 #include "GColor.h"
 #include "GMatrix.h"
 #include "GPath.h"
+#include "GPathBuilder.h"
 #include "GPoint.h"
 #include "GRandom.h"
 #include "GRect.h"
@@ -102,6 +103,9 @@ static void draw_bm_tiling(GCanvas* canvas) {
 }
 
 static void draw_cartman(GCanvas* canvas) {
+    // The arena is declared first so that it outlives the paths built in it.
+    GArena arena;
+    GPathBuilder builder(&arena);
     GPath path;
     GPaint paint;
 #include "cartman.475"
@@ -0,0 +1,1299 @@
+/**
+ *  Tests for features added on top of the final assignment.
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include "GBitmap.h"
+#include "GCanvas.h"
+#include "GPath.h"
+#include "GPathBuilder.h"
+#include "GRegion.h"
+#include "GShader.h"
+#include "GStroke.h"
+#include "GRandom.h"
+#include "tests.h"
+
+#include "../Clipper.h"
+#include "../EdgeBuilder.h"
+
+static void test_clip_path(GTestStats* stats) {
+    GSurface surface(10, 10);
+    GCanvas* canvas = surface.canvas();
+    const GBitmap& bm = surface.bitmap();
+
+    const GPixel black = GPixel_PackARGB(0xFF, 0, 0, 0);
+    const GPixel white = GPixel_PackARGB(0xFF, 0xFF, 0xFF, 0xFF);
+
+    canvas->clear({1, 1, 1, 1});
+
+    GPath clip;
+    clip.addRect(GRect::MakeLTRB(2, 2, 8, 8));
+
+    canvas->save();
+    canvas->clipPath(clip);
+    canvas->fillRect(GRect::MakeWH(10, 10), {1, 0, 0, 0});
+    canvas->restore();
+
+    stats->expectTrue(*bm.getAddr(5, 5) == black, "clip_path_inside");
+    stats->expectTrue(*bm.getAddr(0, 0) == white, "clip_path_outside");
+    stats->expectTrue(*bm.getAddr(9, 5) == white, "clip_path_outside_right");
+
+    // After restoring, the clip no longer applies.
+    canvas->fillRect(GRect::MakeWH(10, 10), {1, 0, 0, 0});
+    stats->expectTrue(*bm.getAddr(0, 0) == black, "clip_path_restored");
+
+    // Clipping to a half-covered column should only partially draw it.
+    canvas->clear({1, 1, 1, 1});
+    clip.reset();
+    clip.addRect(GRect::MakeLTRB(0, 0, 4.5f, 10));
+
+    canvas->save();
+    canvas->clipPath(clip);
+    canvas->fillRect(GRect::MakeWH(10, 10), {1, 0, 0, 0});
+    canvas->restore();
+
+    GPixel edge = *bm.getAddr(4, 5);
+    stats->expectTrue(edge != black && edge != white, "clip_path_coverage");
+}
+
+static void test_layer_clip(GTestStats* stats) {
+    GSurface surface(10, 10);
+    GCanvas* canvas = surface.canvas();
+    const GBitmap& bm = surface.bitmap();
+
+    const GPixel black = GPixel_PackARGB(0xFF, 0, 0, 0);
+    const GPixel white = GPixel_PackARGB(0xFF, 0xFF, 0xFF, 0xFF);
+
+    GPaint src;
+    src.setBlendMode(GBlendMode::kSrc);
+
+    // A layer composited with kSrc replaces what is under it, including the
+    // transparent pixels outside the clip, unless the composite is clipped.
+    canvas->clear({1, 1, 1, 1});
+    canvas->save();
+    canvas->clipRect(GRect::MakeLTRB(2, 2, 6, 6));
+    canvas->saveLayer(src);
+    canvas->fillRect(GRect::MakeWH(10, 10), {1, 0, 0, 0});
+    canvas->restore();
+    canvas->restore();
+
+    stats->expectTrue(*bm.getAddr(3, 3) == black, "layer_clip_rect_inside");
+    stats->expectTrue(*bm.getAddr(0, 0) == white && *bm.getAddr(8, 4) == white,
+                      "layer_clip_rect_outside");
+
+    GPath clip;
+    clip.addRect(GRect::MakeLTRB(2, 2, 6, 6));
+
+    canvas->clear({1, 1, 1, 1});
+    canvas->save();
+    canvas->clipPath(clip);
+    canvas->saveLayer(src);
+    canvas->fillRect(GRect::MakeWH(10, 10), {1, 0, 0, 0});
+    canvas->restore();
+    canvas->restore();
+
+    stats->expectTrue(*bm.getAddr(3, 3) == black, "layer_clip_path_inside");
+    stats->expectTrue(*bm.getAddr(0, 0) == white && *bm.getAddr(8, 4) == white,
+                      "layer_clip_path_outside");
+}
+
+static void test_region_ops(GTestStats* stats) {
+    GRegion region(GIRect::MakeLTRB(0, 0, 10, 10));
+    region.op(GIRect::MakeLTRB(5, 5, 20, 20), GRegion::kUnion_Op);
+
+    stats->expectTrue(region.getBounds() == GIRect::MakeLTRB(0, 0, 20, 20), "region_union_bounds");
+    stats->expectTrue(region.contains(2, 2) && region.contains(15, 15), "region_union_contains");
+    stats->expectFalse(region.contains(15, 2), "region_union_gap");
+
+    region.op(GIRect::MakeLTRB(4, 4, 6, 6), GRegion::kDifference_Op);
+    stats->expectFalse(region.contains(5, 5), "region_difference");
+    stats->expectTrue(region.contains(3, 5) && region.contains(6, 5), "region_difference_keep");
+
+    region.op(GIRect::MakeLTRB(0, 0, 5, 5), GRegion::kIntersect_Op);
+    stats->expectTrue(region.getBounds() == GIRect::MakeLTRB(0, 0, 5, 5), "region_intersect");
+
+    int count;
+    region.getRow(4, &count);
+    stats->expectEQ(count, 1, "region_row_spans");
+    region.getRow(5, &count);
+    stats->expectEQ(count, 0, "region_row_outside");
+
+    // Combining random rectangles matches combining their pixels one by one,
+    // including rows whose spans touch or share ends.
+    GRandom rand(7);
+    GRegion combined;
+    bool pixels[16][16] = {};
+    bool matches = true;
+    for (int i = 0; i < 40; ++i) {
+        int left = rand.nextRange(0, 15);
+        int top = rand.nextRange(0, 15);
+        GIRect rect = GIRect::MakeLTRB(left, top, rand.nextRange(left, 16), rand.nextRange(top, 16));
+        GRegion::Op op = (GRegion::Op) rand.nextRange(0, 2);
+        if (i < 10) {
+            op = GRegion::kUnion_Op;
+        }
+
+        combined.op(rect, op);
+        for (int y = 0; y < 16; ++y) {
+            for (int x = 0; x < 16; ++x) {
+                bool inRect = rect.contains(x, y);
+                pixels[y][x] = op == GRegion::kUnion_Op ? pixels[y][x] || inRect
+                    : op == GRegion::kIntersect_Op ? pixels[y][x] && inRect
+                    : pixels[y][x] && !inRect;
+                matches &= combined.contains(x, y) == pixels[y][x];
+            }
+        }
+    }
+    stats->expectTrue(matches, "region_ops_random");
+}
+
+static void test_clip_rect_difference(GTestStats* stats) {
+    GSurface surface(10, 10);
+    GCanvas* canvas = surface.canvas();
+    const GBitmap& bm = surface.bitmap();
+
+    const GPixel black = GPixel_PackARGB(0xFF, 0, 0, 0);
+    const GPixel white = GPixel_PackARGB(0xFF, 0xFF, 0xFF, 0xFF);
+
+    canvas->clear({1, 1, 1, 1});
+
+    canvas->save();
+    canvas->clipRect(GRect::MakeLTRB(0, 0, 10, 10));
+    canvas->clipRect(GRect::MakeLTRB(2, 2, 8, 8), GCanvas::kDifference_ClipOp);
+    canvas->fillRect(GRect::MakeWH(10, 10), {1, 0, 0, 0});
+    canvas->restore();
+
+    stats->expectTrue(*bm.getAddr(0, 0) == black, "clip_rect_difference_outside");
+    stats->expectTrue(*bm.getAddr(5, 5) == white, "clip_rect_difference_inside");
+}
+
+static void test_quick_reject(GTestStats* stats) {
+    GSurface surface(10, 10);
+    GCanvas* canvas = surface.canvas();
+
+    stats->expectFalse(canvas->quickReject(GRect::MakeLTRB(5, 5, 6, 6)), "quick_reject_inside");
+    stats->expectTrue(canvas->quickReject(GRect::MakeLTRB(20, 20, 30, 30)), "quick_reject_outside");
+
+    canvas->save();
+    canvas->translate(-100, 0);
+    stats->expectTrue(canvas->quickReject(GRect::MakeLTRB(5, 5, 6, 6)), "quick_reject_ctm");
+    canvas->restore();
+
+    canvas->save();
+    canvas->clipRect(GRect::MakeLTRB(0, 0, 2, 2));
+    stats->expectTrue(canvas->quickReject(GRect::MakeLTRB(5, 5, 6, 6)), "quick_reject_clip");
+    canvas->restore();
+
+    stats->expectFalse(canvas->quickReject(GRect::MakeLTRB(5, 5, 6, 6)), "quick_reject_restore");
+}
+
+static void test_guard_band_edges(GTestStats* stats) {
+    const GRect bounds = GRect::MakeWH(100, 100);
+
+    // A segment overhanging both sides of the bounds is one edge, where fully
+    // clipping it projects each overhang onto an edge of its own.
+    Edge edges[3];
+    int count = (int) (clipLineToGuardBand({-50, 10}, {150, 90}, bounds, edges) - edges);
+    stats->expectEQ(count, 1, "guard_band_overhang");
+    count = (int) (clipLine({-50, 10}, {150, 90}, bounds, edges) - edges);
+    stats->expectEQ(count, 3, "guard_band_clip_line");
+
+    // A path reaching past the guard band is still clipped there: the
+    // diagonal becomes a projected edge and what is left of it, and the
+    // horizontal top produces nothing.
+    GPath path;
+    path.moveTo({-50000, 10}).lineTo({50, 90}).lineTo({50, 10});
+    stats->expectEQ((int) buildPathEdges(path, GMatrix(), bounds).edges.size(), 3,
+                    "guard_band_path_edges");
+
+    GSurface surface(100, 100);
+    surface.canvas()->clear({1, 1, 1, 1});
+    surface.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+
+    auto filled = [&](int x, int y) { return GPixel_GetR(*surface.bitmap().getAddr(x, y)) == 0; };
+    stats->expectTrue(filled(0, 15) && filled(0, 85) && filled(49, 11), "guard_band_path_fill");
+    stats->expectTrue(!filled(50, 50) && !filled(0, 5) && !filled(0, 95), "guard_band_path_empty");
+}
+
+static void test_batch_clip(GTestStats* stats) {
+    const GRect bounds = GRect::MakeWH(100, 100);
+    const int count = 203;
+
+    // Most segments overhang the bounds a little, some leave the guard band
+    // and some are horizontal. The count leaves a partial vector at the end.
+    GRandom rand(42);
+    auto coord = [&]() {
+        return rand.nextRange(0, 9) == 0 ? rand.nextF() * 80000 - 40000 : rand.nextF() * 200 - 50;
+    };
+
+    std::vector<GPoint> points(2 * count);
+    for (int i = 0; i < count; ++i) {
+        points[2 * i] = { coord(), coord() };
+        points[2 * i + 1] = { coord(), rand.nextRange(0, 9) == 0 ? points[2 * i].fY : coord() };
+    }
+
+    std::vector<Edge> batch(3 * count), scalar(3 * count);
+    batch.resize(clipLinesToGuardBand(points.data(), count, bounds, batch.data()) - batch.data());
+
+    Edge* edge = scalar.data();
+    for (int i = 0; i < count; ++i) {
+        edge = clipLineToGuardBand(points[2 * i], points[2 * i + 1], bounds, edge);
+    }
+    scalar.resize(edge - scalar.data());
+
+    // The batch doesn't keep the segments' order, so compare the edges once
+    // both are sorted. Slopes of clipped segments come from different
+    // endpoints, so they only agree to within rounding.
+    auto byPosition = [](const Edge& a, const Edge& b) {
+        if (a.topY != b.topY) {
+            return a.topY < b.topY;
+        }
+        if (a.bottomY != b.bottomY) {
+            return a.bottomY < b.bottomY;
+        }
+        if (a.wind != b.wind) {
+            return a.wind < b.wind;
+        }
+        return a.curX < b.curX;
+    };
+    std::sort(batch.begin(), batch.end(), byPosition);
+    std::sort(scalar.begin(), scalar.end(), byPosition);
+
+    auto close = [](float a, float b) { return fabsf(a - b) <= 0.001f * (1 + fabsf(b)); };
+
+    bool same = batch.size() == scalar.size();
+    for (size_t i = 0; same && i < batch.size(); ++i) {
+        same = batch[i].topY == scalar[i].topY && batch[i].bottomY == scalar[i].bottomY
+            && batch[i].wind == scalar[i].wind && batch[i].curve == -1
+            && close(batch[i].curX, scalar[i].curX) && close(batch[i].dxdy, scalar[i].dxdy);
+    }
+    stats->expectTrue((int) scalar.size() > count / 2, "batch_clip_edges");
+    stats->expectTrue(same, "batch_clip_matches_scalar");
+}
+
+static bool nearly_eq(GPoint a, GPoint b) {
+    return fabs(a.fX - b.fX) < 0.0001f && fabs(a.fY - b.fY) < 0.0001f;
+}
+
+static void test_path_chop(GTestStats* stats) {
+    const GPoint quad[] = { {0, 0}, {10, 20}, {20, 0} };
+    GPoint dst[10];
+
+    GPath::ChopQuadAt(quad, dst, 0.25f);
+    float t[] = { 0.25f };
+    GPoint mid;
+    GPath::EvalQuadAt(quad, t, &mid, 1);
+    stats->expectTrue(nearly_eq(dst[2], mid), "chop_quad_at");
+    stats->expectTrue(dst[0] == quad[0] && dst[4] == quad[2], "chop_quad_ends");
+
+    stats->expectEQ(GPath::ChopQuadAtYExtrema(quad, dst), 2, "chop_quad_extrema");
+    stats->expectTrue(nearly_eq(dst[2], {10, 10}), "chop_quad_extrema_point");
+
+    const GPoint cubic[] = { {0, 0}, {10, 30}, {20, -30}, {30, 0} };
+    GPath::ChopCubicAt(cubic, dst, 0.5f);
+    stats->expectTrue(nearly_eq(dst[3], {15, 0}), "chop_cubic_at");
+
+    stats->expectEQ(GPath::ChopCubicAtYExtrema(cubic, dst), 3, "chop_cubic_extrema");
+    bool monotonic = true;
+    for (int i = 0; i < 3; ++i) {
+        const GPoint* piece = dst + 3 * i;
+        float dir = piece[3].fY - piece[0].fY;
+        for (int j = 0; j < 3; ++j) {
+            monotonic &= (piece[j + 1].fY - piece[j].fY) * dir >= 0;
+        }
+    }
+    stats->expectTrue(monotonic, "chop_cubic_extrema_monotonic");
+
+    float ts[] = { 0, 0.1f, 0.2f, 0.5f, 0.7f, 1 };
+    GPoint pts[6];
+    GPath::EvalCubicAt(cubic, ts, pts, 6);
+    stats->expectTrue(nearly_eq(pts[0], cubic[0]) && nearly_eq(pts[5], cubic[3]), "eval_cubic_ends");
+    stats->expectTrue(nearly_eq(pts[3], {15, 0}), "eval_cubic_mid");
+}
+
+static void test_curve_edges(GTestStats* stats) {
+    // A blob made of curves that wind in both directions vertically.
+    GPath path;
+    path.moveTo({10, 40});
+    path.cubicTo({10, -10}, {90, -10}, {90, 40});
+    path.quadTo({90, 90}, {50, 70});
+    path.cubicTo({30, 60}, {10, 95}, {10, 40});
+
+    GSurface full(100, 100);
+    full.canvas()->clear({1, 1, 1, 1});
+    full.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+
+    // Drawing the same path shifted up means every curve edge is stepped past
+    // the top of the clip before producing its first segment.
+    GSurface clipped(100, 60);
+    clipped.canvas()->clear({1, 1, 1, 1});
+    clipped.canvas()->translate(0, -40);
+    clipped.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+
+    int mismatches = 0;
+    int filled = 0;
+    for (int y = 0; y < 60; ++y) {
+        for (int x = 0; x < 100; ++x) {
+            GPixel expected = *full.bitmap().getAddr(x, y + 40);
+            mismatches += expected != *clipped.bitmap().getAddr(x, y);
+            filled += GPixel_GetR(expected) == 0;
+        }
+    }
+
+    stats->expectTrue(filled > 1000, "curve_edges_filled");
+    stats->expectEQ(mismatches, 0, "curve_edges_clipped_top");
+}
+
+static void test_curve_flatten_scale(GTestStats* stats) {
+    // The number of segments grows with the square root of a curve's size,
+    // so scaling it up 16 times needs about 4 times as many.
+    const GPoint quad[] = { {0, 0}, {100, 0}, {100, 100} };
+    const GPoint cubic[] = { {0, 0}, {100, 0}, {0, 100}, {100, 100} };
+
+    GPoint bigQuad[3], bigCubic[4];
+    GMatrix scale;
+    scale.setScale(16, 16);
+    scale.mapPoints(bigQuad, quad, 3);
+    scale.mapPoints(bigCubic, cubic, 4);
+
+    auto grows = [](int small, int big) {
+        return small > 1 && big >= 3 * small && big <= 5 * small;
+    };
+
+    stats->expectTrue(grows(countQuadSegments(quad, kDefaultFlattenTolerance),
+                            countQuadSegments(bigQuad, kDefaultFlattenTolerance)),
+                      "curve_flatten_scale_quad");
+    stats->expectTrue(grows(countCubicSegments(cubic, kDefaultFlattenTolerance),
+                            countCubicSegments(bigCubic, kDefaultFlattenTolerance)),
+                      "curve_flatten_scale_cubic");
+
+    // Curves are flattened after the CTM is applied, so a path drawn scaled
+    // up is stepped in as many segments as its device space points need.
+    GPath path;
+    path.moveTo(quad[0]).quadTo(quad[1], quad[2]);
+
+    const GRect bounds = GRect::MakeWH(2000, 2000);
+    PathEdges small = buildPathEdges(path, GMatrix(), bounds);
+    PathEdges big = buildPathEdges(path, scale, bounds);
+
+    stats->expectTrue(small.curves.size() == 1 && big.curves.size() == 1
+                      && grows(small.curves[0].count, big.curves[0].count),
+                      "curve_flatten_scale_ctm");
+}
+
+static void test_path_oval(GTestStats* stats) {
+    GPath path;
+    GRect bounds;
+
+    path.addOval(GRect::MakeLTRB(10, 20, 50, 40));
+    stats->expectTrue(path.isOval(&bounds), "oval_is_oval");
+    stats->expectTrue(bounds == GRect::MakeLTRB(10, 20, 50, 40), "oval_bounds");
+
+    path.reset();
+    path.addCircle({30, 30}, 20, GPath::kCCW_Direction);
+    stats->expectTrue(path.isOval(&bounds), "oval_circle_ccw");
+
+    GMatrix scale;
+    scale.setScale(2, 3);
+    path.transform(scale);
+    stats->expectTrue(path.isOval(&bounds), "oval_scaled");
+
+    path.lineTo({0, 0});
+    stats->expectFalse(path.isOval(&bounds), "oval_extra_verb");
+
+    path.reset();
+    path.addRect(GRect::MakeWH(10, 10));
+    stats->expectFalse(path.isOval(&bounds), "oval_rect");
+
+    // The analytic fill should agree with scan converting the curves, apart
+    // from pixels near the outline where the flattened curve, which lies just
+    // inside the true circle, crosses a pixel center. Nothing should be
+    // filled by the flattened curve that the exact circle misses.
+    GPath oval;
+    oval.addCircle({50, 50}, 37.3f);
+
+    GPath curves = oval;
+    curves.moveTo({0, 0});
+    stats->expectFalse(curves.isOval(&bounds), "oval_not_oval");
+
+    GSurface a(100, 100), b(100, 100);
+    a.canvas()->clear({1, 1, 1, 1});
+    b.canvas()->clear({1, 1, 1, 1});
+    a.canvas()->drawPath(oval, GPaint({1, 0, 0, 0}));
+    b.canvas()->drawPath(curves, GPaint({1, 0, 0, 0}));
+
+    int onlyOval = 0;
+    int onlyCurves = 0;
+    for (int y = 0; y < 100; ++y) {
+        for (int x = 0; x < 100; ++x) {
+            bool inOval = GPixel_GetR(*a.bitmap().getAddr(x, y)) == 0;
+            bool inCurves = GPixel_GetR(*b.bitmap().getAddr(x, y)) == 0;
+
+            onlyOval += inOval && !inCurves;
+            onlyCurves += inCurves && !inOval;
+        }
+    }
+    stats->expectTrue(onlyOval <= 40, "oval_fill_matches_path");
+    stats->expectEQ(onlyCurves, 0, "oval_fill_contains_path");
+}
+
+static void test_path_generation_id(GTestStats* stats) {
+    GPath path;
+    path.moveTo({0, 0}).lineTo({10, 0}).lineTo({0, 10});
+    uint32_t id = path.getGenerationID();
+
+    stats->expectEQ(path.getGenerationID(), id, "gen_id_stable");
+
+    GPath copy = path;
+    stats->expectEQ(copy.getGenerationID(), id, "gen_id_copy");
+
+    copy.lineTo({5, 5});
+    stats->expectTrue(copy.getGenerationID() != id, "gen_id_modified");
+    stats->expectEQ(path.getGenerationID(), id, "gen_id_original");
+
+    GMatrix m;
+    m.setTranslate(1, 1);
+    path.transform(m);
+    stats->expectTrue(path.getGenerationID() != id, "gen_id_transform");
+}
+
+static void test_edge_cache_offset(GTestStats* stats) {
+    GPath path;
+    path.moveTo({5, 3});
+    path.cubicTo({60, -20}, {40, 70}, {55, 45});
+    path.quadTo({20, 60}, {5, 3});
+
+    // Drawing the path twice primes the cache; every later draw moves the
+    // cached edges and must match a canvas that builds them from scratch.
+    // The last offset pushes the path partly outside the canvas, where its
+    // edges are built against the clip instead.
+    GSurface cached(100, 120);
+    cached.canvas()->save();
+    cached.canvas()->translate(0, 25);
+    cached.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+    cached.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+    cached.canvas()->restore();
+
+    const GPoint offsets[] = { {10, 7}, {3.25f, 20}, {15.5f, 30}, {20.75f, 12}, {-15.5f, 50} };
+
+    bool matches = true;
+    for (GPoint offset : offsets) {
+        // Moving the points themselves gives the path a new ID, so its edges
+        // are built from scratch.
+        GMatrix m;
+        m.setTranslate(offset.x(), offset.y() + 25);
+        GPath moved = path;
+        moved.transform(m);
+
+        GSurface fresh(100, 120);
+        fresh.canvas()->clear({1, 1, 1, 1});
+        fresh.canvas()->drawPath(moved, GPaint({1, 0, 0, 0}));
+
+        cached.canvas()->clear({1, 1, 1, 1});
+        cached.canvas()->save();
+        cached.canvas()->translate(offset.x(), offset.y() + 25);
+        cached.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+        cached.canvas()->restore();
+
+        for (int y = 0; y < 120; ++y) {
+            for (int x = 0; x < 100; ++x) {
+                matches &= *fresh.bitmap().getAddr(x, y) == *cached.bitmap().getAddr(x, y);
+            }
+        }
+    }
+
+    stats->expectTrue(matches, "edge_cache_offset");
+}
+
+static void test_edge_cache_identical_edges(GTestStats* stats) {
+    // Many copies of one rectangle give edges that compare equal, which the
+    // edge sort has to handle when the path is cached.
+    GPath path;
+    for (int i = 0; i < 200; ++i) {
+        path.addRect(GRect::MakeLTRB(10, 10, 100, 100));
+    }
+
+    GSurface surface(120, 120);
+    bool filled = true;
+    for (int draw = 0; draw < 3; ++draw) {
+        surface.canvas()->clear({1, 1, 1, 1});
+        surface.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+
+        for (int y = 0; y < 120; y += 5) {
+            for (int x = 0; x < 120; x += 5) {
+                bool inside = x >= 10 && x < 100 && y >= 10 && y < 100;
+                GPixel expected = inside ? GPixel_PackARGB(0xFF, 0, 0, 0)
+                                         : GPixel_PackARGB(0xFF, 0xFF, 0xFF, 0xFF);
+                filled &= *surface.bitmap().getAddr(x, y) == expected;
+            }
+        }
+    }
+    stats->expectTrue(filled, "edge_cache_identical_edges");
+}
+
+static void test_edge_cache_oversized(GTestStats* stats) {
+    // Small rectangles scattered over the canvas give more edges than the
+    // cache holds, so the path's edges are built for the cache and then used
+    // uncached.
+    GRandom rand;
+    GPath path;
+    for (int i = 0; i < 30000; ++i) {
+        float x = rand.nextF() * 60;
+        float y = rand.nextF() * 60;
+        path.addRect(GRect::MakeXYWH(x, y, 0.75f, 2));
+    }
+
+    GMatrix m;
+    m.setTranslate(10.5f, 7);
+    GPath moved = path;
+    moved.transform(m);
+
+    GSurface fresh(100, 100);
+    fresh.canvas()->clear({1, 1, 1, 1});
+    fresh.canvas()->drawPath(moved, GPaint({1, 0, 0, 0}));
+
+    // The first draw only remembers the path; the second builds its edges.
+    GSurface cached(100, 100);
+    bool matches = true;
+    for (int draw = 0; draw < 2; ++draw) {
+        cached.canvas()->clear({1, 1, 1, 1});
+        cached.canvas()->save();
+        cached.canvas()->translate(10.5f, 7);
+        cached.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+        cached.canvas()->restore();
+
+        for (int y = 0; y < 100; ++y) {
+            for (int x = 0; x < 100; ++x) {
+                matches &= *fresh.bitmap().getAddr(x, y) == *cached.bitmap().getAddr(x, y);
+            }
+        }
+    }
+    stats->expectTrue(matches, "edge_cache_oversized");
+}
+
+static void test_path_copy_on_write(GTestStats* stats) {
+    GPath path;
+    path.moveTo({0, 0}).lineTo({10, 0}).lineTo({10, 10});
+
+    GPath copy = path;
+    stats->expectTrue(copy == path, "cow_copy_equal");
+
+    // Modifying either path must leave the other one alone.
+    GMatrix m;
+    m.setScale(2, 2);
+    copy.transform(m);
+    stats->expectTrue(path.bounds() == GRect::MakeLTRB(0, 0, 10, 10), "cow_transform_original");
+    stats->expectTrue(copy.bounds() == GRect::MakeLTRB(0, 0, 20, 20), "cow_transform_copy");
+
+    GPath other;
+    other = path;
+    path.lineTo({0, 20});
+    stats->expectEQ(other.countPoints(), 3, "cow_append_copy");
+    stats->expectEQ(path.countPoints(), 4, "cow_append_original");
+
+    other.reset();
+    stats->expectEQ(other.countPoints(), 0, "cow_reset_copy");
+    stats->expectEQ(path.countPoints(), 4, "cow_reset_original");
+
+    GPath empty1, empty2;
+    empty1.moveTo({1, 1});
+    stats->expectEQ(empty2.countPoints(), 0, "cow_shared_empty");
+}
+
+static void test_path_metadata(GTestStats* stats) {
+    GPath path;
+    stats->expectTrue(path.bounds() == GRect::MakeWH(0, 0), "meta_empty_bounds");
+
+    path.moveTo({5, 5}).lineTo({20, 0}).quadTo({30, 10}, {20, 20}).cubicTo({15, 25}, {0, 25}, {5, 5});
+    stats->expectTrue(path.bounds() == GRect::MakeLTRB(0, 0, 30, 25), "meta_bounds");
+    stats->expectEQ(path.countVerbs(GPath::kMove), 1, "meta_count_move");
+    stats->expectEQ(path.countVerbs(GPath::kLine), 1, "meta_count_line");
+    stats->expectEQ(path.countVerbs(GPath::kQuad), 1, "meta_count_quad");
+    stats->expectEQ(path.countVerbs(GPath::kCubic), 1, "meta_count_cubic");
+    stats->expectTrue(path.isConvex(), "meta_convex_curves");
+
+    GMatrix m;
+    m.setScale(2, -1);
+    path.transform(m);
+    stats->expectTrue(path.bounds() == GRect::MakeLTRB(0, -25, 60, 0), "meta_transform_bounds");
+    stats->expectTrue(path.isConvex(), "meta_transform_convex");
+
+    path.reset();
+    stats->expectEQ(path.countVerbs(GPath::kLine), 0, "meta_reset_count");
+
+    path.addRect(GRect::MakeWH(10, 10));
+    stats->expectTrue(path.isConvex(), "meta_rect_convex");
+
+    path.addRect(GRect::MakeLTRB(20, 0, 30, 10));
+    stats->expectFalse(path.isConvex(), "meta_two_contours");
+
+    GPoint star[5];
+    for (int i = 0; i < 5; ++i) {
+        float angle = i * 4 * M_PI / 5;
+        star[i] = { 50 + 40 * cosf(angle), 50 + 40 * sinf(angle) };
+    }
+    path.reset();
+    path.addPolygon(star, 5);
+    stats->expectFalse(path.isConvex(), "meta_star");
+
+    const GPoint dart[] = { {0, 0}, {20, 10}, {0, 20}, {5, 10} };
+    path.reset();
+    path.addPolygon(dart, 4);
+    stats->expectFalse(path.isConvex(), "meta_dart");
+
+    // Convex paths take the simpler scan converter, which must agree with the
+    // general one, curves included.
+    path.reset();
+    path.moveTo({10, 40}).lineTo({50, 5}).quadTo({90, 10}, {90, 50}).cubicTo({90, 80}, {40, 95}, {10, 40});
+    stats->expectTrue(path.isConvex(), "meta_convex_fill_path");
+
+    GPath complex = path;
+    complex.moveTo({0, 0});
+
+    GSurface a(100, 100), b(100, 100);
+    a.canvas()->clear({1, 1, 1, 1});
+    b.canvas()->clear({1, 1, 1, 1});
+    a.canvas()->rotate(0.1f);
+    b.canvas()->rotate(0.1f);
+    a.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+    b.canvas()->drawPath(complex, GPaint({1, 0, 0, 0}));
+
+    bool matches = true;
+    for (int y = 0; y < 100; ++y) {
+        for (int x = 0; x < 100; ++x) {
+            matches &= *a.bitmap().getAddr(x, y) == *b.bitmap().getAddr(x, y);
+        }
+    }
+    stats->expectTrue(matches, "meta_convex_fill");
+}
+
+static void test_path_builder_arena(GTestStats* stats) {
+    GArena arena(256);
+
+    const GPoint tri[] = { {0, 0}, {10, 0}, {5, 8} };
+
+    // Build the same "frame" of paths twice. Once the arena has grown to hold
+    // a frame, the second frame fits in it without growing further.
+    size_t capacity = 0;
+    bool sameContents = true;
+    for (int frame = 0; frame < 2; ++frame) {
+        arena.reset();
+        GPathBuilder builder(&arena);
+
+        for (int i = 0; i < 100; ++i) {
+            GPath path = builder.reserve(3, 3).addPolygon(tri, 3).detach();
+
+            GPath expected;
+            expected.addPolygon(tri, 3);
+            sameContents &= path == expected && path.bounds() == expected.bounds();
+        }
+
+        if (frame == 0) {
+            capacity = arena.capacity();
+        }
+    }
+    stats->expectTrue(sameContents, "arena_path_contents");
+    stats->expectTrue(capacity > 0 && arena.capacity() == capacity, "arena_reused");
+
+    // A copy of an arena path moves to the heap as soon as it is modified.
+    GPath copy;
+    {
+        GArena scratch;
+        GPath path = GPathBuilder(&scratch).addPolygon(tri, 3).detach();
+        copy = path;
+        copy.lineTo({0, 5});
+    }
+    stats->expectEQ(copy.countPoints(), 4, "arena_copy_on_write");
+    stats->expectTrue(copy.bounds() == GRect::MakeLTRB(0, 0, 10, 8), "arena_copy_bounds");
+
+    GPath heap = GPathBuilder().addRect(GRect::MakeWH(4, 4)).detach();
+    stats->expectTrue(heap.isConvex() && heap.countPoints() == 4, "builder_heap");
+}
+
+static void test_decimate_plot(GTestStats* stats) {
+    // Far more samples than pixels, which makes drawPath merge the segments.
+    const int N = 20000;
+    auto f = [](float x) { return 50 + 30 * sinf(x / 10); };
+
+    GPath path;
+    path.moveTo({0, 100});
+    for (int i = 0; i <= N; ++i) {
+        float x = 100.0f * i / N;
+        path.lineTo({x, f(x)});
+    }
+    path.lineTo({100, 100});
+
+    GSurface surface(100, 100);
+    surface.canvas()->clear({1, 1, 1, 1});
+    surface.canvas()->drawPath(path, GPaint({1, 0, 0, 0}));
+
+    // Merged segments stay within a quarter pixel of the samples, so only
+    // pixel centers that close to the curve may come out differently. The
+    // distance is measured perpendicular to the curve.
+    int wrong = 0;
+    for (int y = 0; y < 100; ++y) {
+        for (int x = 0; x < 100; ++x) {
+            float curve = f(x + 0.5f);
+            float slope = 3 * cosf((x + 0.5f) / 10);
+            float dist = fabsf(y + 0.5f - curve) / sqrtf(1 + slope * slope);
+            bool filled = GPixel_GetR(*surface.bitmap().getAddr(x, y)) == 0;
+
+            if (dist > 0.3f && filled != (y + 0.5f > curve)) {
+                wrong++;
+            }
+        }
+    }
+    stats->expectEQ(wrong, 0, "decimate_plot");
+}
+
+static void test_stroke(GTestStats* stats) {
+    GPath line;
+    line.moveTo({0, 5}).lineTo({10, 5});
+
+    GPath butt;
+    GStroke(4).strokePath(line, &butt);
+    stats->expectTrue(butt.bounds() == GRect::MakeLTRB(0, 3, 10, 7), "stroke_butt");
+
+    GPath square;
+    GStroke(4, GStroke::kMiter_Join, GStroke::kSquare_Cap).strokePath(line, &square);
+    stats->expectTrue(square.bounds() == GRect::MakeLTRB(-2, 3, 12, 7), "stroke_square");
+
+    GPath round;
+    GStroke(4, GStroke::kMiter_Join, GStroke::kRound_Cap).strokePath(line, &round);
+    stats->expectTrue(round.bounds() == GRect::MakeLTRB(-2, 3, 12, 7), "stroke_round");
+
+    // A sharp corner is mitered only while the miter is within the limit.
+    GPath corner;
+    corner.moveTo({0, 0}).lineTo({10, 0}).lineTo({0, 5});
+
+    GPath miter, bevel, roundJoin;
+    GStroke(2, GStroke::kMiter_Join, GStroke::kButt_Cap, 10).strokePath(corner, &miter);
+    GStroke(2, GStroke::kMiter_Join, GStroke::kButt_Cap, 4).strokePath(corner, &bevel);
+    GStroke(2, GStroke::kRound_Join).strokePath(corner, &roundJoin);
+    stats->expectTrue(bevel.bounds().right() < 11.01f, "stroke_miter_limit");
+    stats->expectTrue(miter.bounds().right() > bevel.bounds().right() + 1, "stroke_miter");
+    stats->expectTrue(roundJoin.bounds().right() > 10.99f &&
+                      roundJoin.bounds().right() < miter.bounds().right(), "stroke_round_join");
+
+    // A contour that ends where it starts is stroked as a ring.
+    GPath box;
+    box.moveTo({5, 5}).lineTo({15, 5}).lineTo({15, 15}).lineTo({5, 15}).lineTo({5, 5});
+
+    GPath ring;
+    GStroke(2).strokePath(box, &ring);
+
+    GSurface surface(20, 20);
+    surface.canvas()->clear({1, 1, 1, 1});
+    surface.canvas()->drawPath(ring, GPaint({1, 0, 0, 0}));
+
+    auto filled = [&](int x, int y) { return GPixel_GetR(*surface.bitmap().getAddr(x, y)) == 0; };
+    stats->expectTrue(filled(4, 4) && filled(15, 15) && filled(10, 5), "stroke_ring");
+    stats->expectTrue(!filled(10, 10) && !filled(2, 10) && !filled(17, 17), "stroke_ring_hole");
+
+    // A zero length line is a dot with round or square caps, and nothing with butt caps.
+    GPath point;
+    point.moveTo({3, 3}).lineTo({3, 3});
+
+    GPath dot, none;
+    GRect oval;
+    GStroke(2, GStroke::kMiter_Join, GStroke::kRound_Cap).strokePath(point, &dot);
+    GStroke(2).strokePath(point, &none);
+    stats->expectTrue(dot.isOval(&oval) && oval == GRect::MakeLTRB(2, 2, 4, 4), "stroke_dot");
+    stats->expectEQ(none.countPoints(), 0, "stroke_butt_dot");
+
+    // Curves are flattened more finely when the outline is drawn scaled up.
+    GPath curve;
+    curve.moveTo({0, 0}).quadTo({10, 10}, {20, 0});
+
+    GPath coarse, fine;
+    GStroke(1).strokePath(curve, &coarse);
+    GStroke(1).strokePath(curve, &fine, 16);
+    stats->expectTrue(fine.countPoints() > 2 * coarse.countPoints(), "stroke_flatten_scale");
+}
+
+static void test_hairline(GTestStats* stats) {
+    GSurface surface(10, 10);
+    GCanvas* canvas = surface.canvas();
+    const GPaint black({1, 0, 0, 0});
+
+    auto count = [&]() {
+        int n = 0;
+        for (int y = 0; y < 10; ++y) {
+            for (int x = 0; x < 10; ++x) {
+                n += GPixel_GetR(*surface.bitmap().getAddr(x, y)) == 0;
+            }
+        }
+        return n;
+    };
+    auto filled = [&](int x, int y) { return GPixel_GetR(*surface.bitmap().getAddr(x, y)) == 0; };
+
+    // A horizontal hairline covers the pixels from one end to the other on
+    // one row, including the pixels holding its ends.
+    GPath line;
+    line.moveTo({1.5f, 5.5f}).lineTo({8.5f, 5.5f});
+    canvas->clear({1, 1, 1, 1});
+    canvas->drawStrokedPath(line, GStroke(0), black);
+    stats->expectEQ(count(), 8, "hairline_count");
+    stats->expectTrue(filled(1, 5) && filled(8, 5) && !filled(0, 5) && !filled(9, 5),
+                      "hairline_row");
+
+    // The apex of a V has no pixel center on either arm, but is still drawn,
+    // and only once.
+    GPath vee;
+    vee.moveTo({1.5f, 1.5f}).lineTo({5.3f, 5.3f}).lineTo({9, 1.5f});
+    canvas->clear({1, 1, 1, 1});
+    canvas->drawStrokedPath(vee, GStroke(0), GPaint({0.5f, 0, 0, 0}));
+    int apex = GPixel_GetR(*surface.bitmap().getAddr(5, 5));
+    stats->expectTrue(apex > 0x70 && apex < 0x90, "hairline_apex");
+
+    // A diagonal hairline that runs far off the canvas is clipped to it.
+    GPath diagonal;
+    diagonal.moveTo({-100, -100}).lineTo({200, 200});
+    canvas->clear({1, 1, 1, 1});
+    canvas->drawStrokedPath(diagonal, GStroke(1), black);
+    bool onDiagonal = count() == 10;
+    for (int i = 0; i < 10; ++i) {
+        onDiagonal &= filled(i, i);
+    }
+    stats->expectTrue(onDiagonal, "hairline_clipped");
+
+    // A point shared by two segments is drawn once, so a closed hairline
+    // touches each pixel of a rectangle's outline exactly once.
+    GPath box;
+    box.moveTo({2.5f, 2.5f}).lineTo({7.5f, 2.5f}).lineTo({7.5f, 7.5f})
+       .lineTo({2.5f, 7.5f}).lineTo({2.5f, 2.5f});
+    canvas->clear({1, 1, 1, 1});
+    canvas->drawStrokedPath(box, GStroke(1), GPaint({0.5f, 0, 0, 0}));
+    int doubled = 0;
+    for (int y = 0; y < 10; ++y) {
+        for (int x = 0; x < 10; ++x) {
+            doubled += GPixel_GetR(*surface.bitmap().getAddr(x, y)) < 0x70;
+        }
+    }
+    stats->expectEQ(doubled, 0, "hairline_shared_points");
+
+    // Once the CTM makes the stroke wider than a pixel, its outline is filled.
+    GSurface wide(10, 10), filledPath(10, 10);
+    wide.canvas()->clear({1, 1, 1, 1});
+    wide.canvas()->scale(4, 4);
+    wide.canvas()->drawStrokedPath(line, GStroke(1), black);
+
+    GPath outline;
+    GStroke(1).strokePath(line, &outline);
+    filledPath.canvas()->clear({1, 1, 1, 1});
+    filledPath.canvas()->scale(4, 4);
+    filledPath.canvas()->drawPath(outline, black);
+    bool same = true;
+    for (int y = 0; y < 10; ++y) {
+        for (int x = 0; x < 10; ++x) {
+            same &= *wide.bitmap().getAddr(x, y) == *filledPath.bitmap().getAddr(x, y);
+        }
+    }
+    stats->expectTrue(same, "hairline_scaled_stroke");
+}
+
+static void test_linear_gradient_lut(GTestStats* stats) {
+    // A single color is a solid gradient.
+    const GColor solid = {1, 0.5f, 0.25f, 1};
+    auto one = GCreateLinearGradient({0, 0}, {10, 0}, &solid, 1, GShader::kClamp);
+    GPixel row[512];
+    stats->expectTrue(one->setContext(GMatrix()), "lut_single_context");
+    one->shadeRow(-5, 3, 20, row);
+    bool allSolid = true;
+    for (int i = 0; i < 20; ++i) {
+        allSolid &= row[i] == GPixel_PackARGB(0xFF, 0x80, 0x40, 0xFF);
+    }
+    stats->expectTrue(allSolid, "lut_single_color");
+
+    // Black to white across 255 pixels steps one gray level per pixel, and
+    // the table keeps each pixel within a level of the exact gradient.
+    const GColor colors[] = {{1, 0, 0, 0}, {1, 1, 1, 1}};
+    int worst = 0;
+    for (auto tile : { GShader::kClamp, GShader::kMirror }) {
+        auto grad = GCreateLinearGradient({0, 0}, {255, 0}, colors, 2, tile);
+        grad->setContext(GMatrix());
+        grad->shadeRow(0, 0, 510, row);
+
+        for (int x = 0; x < 510; ++x) {
+            int expected = x <= 255 ? x : (tile == GShader::kClamp ? 255 : 510 - x);
+            worst = std::max(worst, abs(GPixel_GetR(row[x]) - expected));
+        }
+    }
+    stats->expectTrue(worst <= 1, "lut_accuracy");
+}
+
+static void test_gradient_stepping(GTestStats* stats) {
+    GSurface surface(10, 10);
+    const GColor colors[] = {{1, 1, 0, 0}, {0.5f, 0, 1, 0}, {1, 0, 0, 1}};
+
+    std::unique_ptr<GShader> shaders[] = {
+        GCreateLinearGradient({10, 20}, {90, 60}, colors, 3, GShader::kMirror),
+        GCreateLinearGradient({10, 20}, {30, 25}, colors, 3, GShader::kRepeat),
+        surface.canvas()->final_createRadialGradient({40, 50}, 70, colors, 3),
+    };
+
+    // Shading a whole row steps along it from the first pixel, which must
+    // agree with mapping each pixel on its own.
+    GMatrix ctm;
+    ctm.setConcat(GMatrix::MakeRotate(0.3f), GMatrix::MakeScale(1.5f, 0.75f));
+
+    int worst = 0;
+    for (auto& shader : shaders) {
+        shader->setContext(ctm);
+
+        for (int y = -20; y < 200; y += 17) {
+            GPixel row[301];
+            shader->shadeRow(-50, y, 301, row);
+
+            for (int i = 0; i < 301; i += 7) {
+                GPixel single;
+                shader->shadeRow(-50 + i, y, 1, &single);
+
+                worst = std::max(worst, abs(GPixel_GetA(row[i]) - GPixel_GetA(single)));
+                worst = std::max(worst, abs(GPixel_GetR(row[i]) - GPixel_GetR(single)));
+                worst = std::max(worst, abs(GPixel_GetG(row[i]) - GPixel_GetG(single)));
+                worst = std::max(worst, abs(GPixel_GetB(row[i]) - GPixel_GetB(single)));
+            }
+        }
+    }
+    stats->expectTrue(worst <= 1, "gradient_stepping");
+}
+
+static void test_radial_gradient_tiling(GTestStats* stats) {
+    const GColor colors[] = {{1, 0, 0, 0}, {1, 1, 1, 1}};
+    stats->expectNULL(GCreateRadialGradient({0, 0}, 0, colors, 2).get(), "radial_zero_radius");
+
+    // Along a row through the center, t is the distance from it over 255.
+    GPixel row[600];
+    int worst = 0;
+    for (auto tile : { GShader::kClamp, GShader::kRepeat, GShader::kMirror }) {
+        auto grad = GCreateRadialGradient({0.25f, 0}, 255, colors, 2, tile);
+        grad->setContext(GMatrix());
+        grad->shadeRow(0, 0, 600, row);
+
+        for (int x = 0; x < 600; ++x) {
+            float d = x - 0.25f;
+            int expected;
+            if (tile == GShader::kClamp) {
+                expected = GRoundToInt(std::min(d, 255.0f));
+            } else if (tile == GShader::kRepeat) {
+                expected = GRoundToInt(fmodf(d, 255));
+            } else {
+                float m = fmodf(d, 510);
+                expected = GRoundToInt(m <= 255 ? m : 510 - m);
+            }
+            worst = std::max(worst, abs(GPixel_GetR(row[x]) - expected));
+        }
+    }
+    stats->expectTrue(worst <= 1, "radial_tiling");
+}
+
+static void test_triangle_gradient(GTestStats* stats) {
+    GSurface surface(10, 10);
+    const GPoint pts[] = {{0, 0}, {100, 0}, {0, 100}};
+    const GColor colors[] = {{1, 1, 0, 0}, {1, 0, 1, 0}, {0.5f, 0, 0, 1}};
+
+    auto shader = surface.canvas()->final_createTriangleGradient(pts, colors);
+    stats->expectTrue(shader && shader->setContext(GMatrix()), "triangle_context");
+    stats->expectTrue(!shader->isOpaque(), "triangle_not_opaque");
+
+    // Each corner gets its own color, and colors blend linearly in between.
+    GPixel row[101];
+    shader->shadeRow(0, 0, 101, row);
+    stats->expectTrue(row[0] == GPixel_PackARGB(0xFF, 0xFF, 0, 0), "triangle_corner0");
+    stats->expectTrue(row[100] == GPixel_PackARGB(0xFF, 0, 0xFF, 0), "triangle_corner1");
+    stats->expectTrue(row[25] == GPixel_PackARGB(0xFF, 191, 64, 0), "triangle_quarter");
+
+    GPixel corner;
+    shader->shadeRow(0, 100, 1, &corner);
+    stats->expectTrue(corner == GPixel_PackARGB(0x80, 0, 0, 0x80), "triangle_corner2");
+
+    // A triangle with no area has no gradient.
+    const GPoint flat[] = {{0, 0}, {50, 50}, {100, 100}};
+    auto degenerate = surface.canvas()->final_createTriangleGradient(flat, colors);
+    stats->expectTrue(!degenerate->setContext(GMatrix()), "triangle_degenerate");
+}
+
+static void test_bitmap_bilinear(GTestStats* stats) {
+    GPixel texels[] = {
+        GPixel_PackARGB(0xFF, 0, 0x10, 0x20), GPixel_PackARGB(0xFF, 200, 0x30, 0x40),
+        GPixel_PackARGB(0x80, 0x80, 0, 0x40), GPixel_PackARGB(0x40, 0x10, 0x20, 0x30),
+    };
+
+    // Without any scaling, every pixel lands on a texel's center.
+    GBitmap square(2, 2, 2 * sizeof(GPixel), texels, false);
+    GPixel row[2];
+    bool exact = true;
+    for (auto tile : { GShader::kClamp, GShader::kRepeat, GShader::kMirror }) {
+        auto shader = GCreateBitmapShader(square, GMatrix(), tile, GShader::kBilinear);
+        shader->setContext(GMatrix());
+        for (int y = 0; y < 2; ++y) {
+            shader->shadeRow(0, y, 2, row);
+            exact &= row[0] == texels[2 * y] && row[1] == texels[2 * y + 1];
+        }
+    }
+    stats->expectTrue(exact, "bilinear_identity");
+
+    // Stretched by 8, the pixels between the two texel centers blend them in
+    // sixteenths, and the pixels past them are clamped.
+    GBitmap strip(2, 1, 2 * sizeof(GPixel), texels, true);
+    auto shader = GCreateBitmapShader(strip, GMatrix().postScale(0.125f, 1), GShader::kClamp,
+                                      GShader::kBilinear);
+    shader->setContext(GMatrix());
+    GPixel stretched[16];
+    shader->shadeRow(0, 0, 16, stretched);
+
+    bool blended = true;
+    for (int x = 0; x < 16; ++x) {
+        int fraction = std::max(0, std::min(16, 2 * x - 7));
+        blended &= GPixel_GetA(stretched[x]) == 0xFF;
+        blended &= GPixel_GetR(stretched[x]) == 200 * fraction / 16;
+    }
+    stats->expectTrue(blended, "bilinear_stretch");
+
+    // Repeating blends the last texel into the first across the seam.
+    shader = GCreateBitmapShader(strip, GMatrix().postScale(0.125f, 1), GShader::kRepeat,
+                                 GShader::kBilinear);
+    shader->setContext(GMatrix());
+    shader->shadeRow(0, 0, 1, stretched);
+    stats->expectTrue(GPixel_GetR(stretched[0]) == 200 * 7 / 16, "bilinear_repeat_seam");
+}
+
+static void test_bitmap_mipmap(GTestStats* stats) {
+    // A checkerboard of black and white texels.
+    GPixel texels[16];
+    for (int i = 0; i < 16; ++i) {
+        texels[i] = ((i >> 2) ^ i) & 1 ? GPixel_PackARGB(0xFF, 0xFF, 0xFF, 0xFF)
+                                       : GPixel_PackARGB(0xFF, 0, 0, 0);
+    }
+    GBitmap checker(4, 4, 4 * sizeof(GPixel), texels, true);
+    auto shader = GCreateBitmapShader(checker, GMatrix(), GShader::kClamp, GShader::kBilinear);
+
+    // At full size every texel is drawn as it is.
+    GPixel row[4];
+    stats->expectTrue(shader->setContext(GMatrix()), "mipmap_context");
+    shader->shadeRow(0, 1, 4, row);
+    stats->expectTrue(memcmp(row, &texels[4], sizeof(row)) == 0, "mipmap_full_size");
+
+    // Shrunk to a single pixel, the whole checkerboard is averaged to gray.
+    GPixel gray = GPixel_PackARGB(0xFF, 0x80, 0x80, 0x80);
+    shader->setContext(GMatrix::MakeScale(0.25f));
+    shader->shadeRow(0, 0, 1, row);
+    stats->expectTrue(row[0] == gray, "mipmap_quarter");
+
+    // Halving averages each 2x2 block, which is the same gray for a checkerboard.
+    shader->setContext(GMatrix::MakeScale(0.5f));
+    shader->shadeRow(0, 0, 2, row);
+    stats->expectTrue(row[0] == gray && row[1] == gray, "mipmap_half");
+
+    // Scaling back up samples the bitmap itself again.
+    shader->setContext(GMatrix());
+    shader->shadeRow(0, 0, 4, row);
+    stats->expectTrue(memcmp(row, texels, sizeof(row)) == 0, "mipmap_restored");
+}
+
+static void test_bitmap_mipmap_redraw(GTestStats* stats) {
+    GPixel texels[16];
+    std::fill(texels, texels + 16, GPixel_PackARGB(0xFF, 0xFF, 0, 0));
+    GBitmap bitmap(4, 4, 4 * sizeof(GPixel), texels, true);
+    auto shader = GCreateBitmapShader(bitmap, GMatrix(), GShader::kClamp, GShader::kBilinear);
+    auto other = GCreateBitmapShader(bitmap, GMatrix(), GShader::kClamp, GShader::kBilinear);
+
+    GPixel pixel;
+    shader->setContext(GMatrix::MakeScale(0.25f));
+    shader->shadeRow(0, 0, 1, &pixel);
+    stats->expectTrue(GPixel_GetR(pixel) == 0xFF && GPixel_GetB(pixel) == 0, "mipmap_redraw_first");
+
+    // Drawing into the bitmap afterwards must show up in its smaller levels,
+    // whichever shader draws it next.
+    std::fill(texels, texels + 16, GPixel_PackARGB(0xFF, 0, 0, 0xFF));
+    shader->setContext(GMatrix::MakeScale(0.25f));
+    shader->shadeRow(0, 0, 1, &pixel);
+    stats->expectTrue(GPixel_GetR(pixel) == 0 && GPixel_GetB(pixel) == 0xFF, "mipmap_redraw_same");
+
+    other->setContext(GMatrix::MakeScale(0.25f));
+    other->shadeRow(0, 0, 1, &pixel);
+    stats->expectTrue(GPixel_GetR(pixel) == 0 && GPixel_GetB(pixel) == 0xFF, "mipmap_redraw_other");
+
+    // So must a different bitmap of the same size at the same address.
+    GBitmap smaller(2, 2, 4 * sizeof(GPixel), texels, true);
+    std::fill(texels, texels + 16, GPixel_PackARGB(0xFF, 0, 0xFF, 0));
+    auto third = GCreateBitmapShader(smaller, GMatrix(), GShader::kClamp, GShader::kBilinear);
+    third->setContext(GMatrix::MakeScale(0.5f));
+    third->shadeRow(0, 0, 1, &pixel);
+    stats->expectTrue(GPixel_GetG(pixel) == 0xFF && GPixel_GetB(pixel) == 0, "mipmap_redraw_layout");
+}
+
+static void test_bitmap_translate(GTestStats* stats) {
+    GPixel texels[6];
+    for (int i = 0; i < 6; ++i) {
+        texels[i] = GPixel_PackARGB(0xFF, i * 40, 0, 0);
+    }
+    GBitmap bitmap(3, 2, 3 * sizeof(GPixel), texels, true);
+
+    // Moved by whole pixels, each pixel is a copy of one texel, and the row
+    // is tiled where it runs off either side of the bitmap.
+    GPixel row[20];
+    bool copied = true;
+    for (auto tile : { GShader::kClamp, GShader::kRepeat, GShader::kMirror }) {
+        for (auto quality : { GShader::kNearest, GShader::kBilinear }) {
+            auto shader = GCreateBitmapShader(bitmap, GMatrix(), tile, quality);
+            shader->setContext(GMatrix::MakeTranslate(5, 0));
+            shader->shadeRow(0, 1, 20, row);
+
+            for (int x = 0; x < 20; ++x) {
+                int sx = x - 5;
+                int expected;
+                if (tile == GShader::kClamp) {
+                    expected = std::max(0, std::min(2, sx));
+                } else if (tile == GShader::kRepeat) {
+                    expected = (sx % 3 + 3) % 3;
+                } else {
+                    int m = (sx % 6 + 6) % 6;
+                    expected = m < 3 ? m : 5 - m;
+                }
+                copied &= row[x] == texels[3 + expected];
+            }
+        }
+    }
+    stats->expectTrue(copied, "bitmap_translate");
+}
+
+static void test_bitmap_tiling_steps(GTestStats* stats) {
+    GPixel texels[15];
+    for (int i = 0; i < 15; ++i) {
+        texels[i] = GPixel_PackARGB(0xFF, i * 16, 0, 0);
+    }
+    GBitmap bitmap(5, 3, 5 * sizeof(GPixel), texels, true);
+
+    // A skewed mapping, reaching well outside the bitmap in both directions,
+    // with steps that fixed point holds exactly.
+    const GMatrix inverse(0.75f, 0.5f, -37, -0.25f, 1, -20);
+
+    GPixel row[40];
+    bool tiled = true;
+    for (auto tile : { GShader::kRepeat, GShader::kMirror }) {
+        auto shader = GCreateBitmapShader(bitmap, inverse, tile);
+        shader->setContext(GMatrix());
+
+        for (int y = 0; y < 4; ++y) {
+            shader->shadeRow(0, y, 40, row);
+
+            for (int x = 0; x < 40; ++x) {
+                GPoint p = inverse.mapXY(x + 0.5f, y + 0.5f);
+                int u = GFloorToInt(p.fX);
+                int v = GFloorToInt(p.fY);
+                if (tile == GShader::kRepeat) {
+                    u = (u % 5 + 5) % 5;
+                    v = (v % 3 + 3) % 3;
+                } else {
+                    u = (u % 10 + 10) % 10;
+                    v = (v % 6 + 6) % 6;
+                    u = u < 5 ? u : 9 - u;
+                    v = v < 3 ? v : 5 - v;
+                }
+                tiled &= row[x] == texels[v * 5 + u];
+            }
+        }
+    }
+    stats->expectTrue(tiled, "bitmap_tiling_steps");
+}
+
+static void test_bitmap_tiling_wide(GTestStats* stats) {
+    // Wide enough that two periods of either tiling don't fit in 16.16 fixed
+    // point, so stepping backwards across the wrap would overflow.
+    const int width = 20000;
+    std::vector<GPixel> texels(width);
+    for (int i = 0; i < width; ++i) {
+        texels[i] = GPixel_PackARGB(0xFF, i & 0xFF, i >> 8, 0);
+    }
+
+    // Mirrored horizontally, so each row runs backwards through the wrap.
+    const GMatrix inverse(-1, 0, 30, 0, 1, 0);
+
+    GPixel row[64];
+    bool tiled = true;
+    for (auto tile : { GShader::kRepeat, GShader::kMirror }) {
+        int size = tile == GShader::kRepeat ? width : width / 2;
+        GBitmap source(size, 1, width * sizeof(GPixel), texels.data(), true);
+
+        auto shader = GCreateBitmapShader(source, inverse, tile);
+        shader->setContext(GMatrix());
+        shader->shadeRow(0, 0, 64, row);
+
+        for (int x = 0; x < 64; ++x) {
+            int u = GFloorToInt(30 - (x + 0.5f));
+            if (tile == GShader::kRepeat) {
+                u = (u % size + size) % size;
+            } else {
+                u = (u % (2 * size) + 2 * size) % (2 * size);
+                u = u < size ? u : 2 * size - 1 - u;
+            }
+            tiled &= row[x] == texels[u];
+        }
+    }
+    stats->expectTrue(tiled, "bitmap_tiling_wide");
+}
+
+static void test_bitmap_swizzled(GTestStats* stats) {
+    // Large enough to be sampled from a tiled copy when rotated, and not a
+    // whole number of tiles across.
+    const int size = 300;
+    std::vector<GPixel> texels(size * size);
+    for (int i = 0; i < size * size; ++i) {
+        texels[i] = GPixel_PackARGB(0xFF, i & 0xFF, (i >> 8) & 0xFF, i >> 16);
+    }
+    GBitmap bitmap(size, size, size * sizeof(GPixel), texels.data(), true);
+
+    // A quarter turn walks down the bitmap's columns, running off its top
+    // edge partway along each row.
+    const GMatrix inverse(0, 1, 0, -1, 0, 299);
+
+    GPixel row[320];
+    bool sampled = true;
+    for (auto tile : { GShader::kClamp, GShader::kRepeat, GShader::kMirror }) {
+        auto shader = GCreateBitmapShader(bitmap, inverse, tile);
+        shader->setContext(GMatrix());
+
+        for (int y = 0; y < size; y += 37) {
+            shader->shadeRow(0, y, 320, row);
+
+            for (int x = 0; x < 320; ++x) {
+                int v = 298 - x;
+                if (tile == GShader::kClamp) {
+                    v = std::max(0, v);
+                } else if (tile == GShader::kRepeat) {
+                    v = (v + size) % size;
+                } else {
+                    v = v < 0 ? -1 - v : v;
+                }
+                sampled &= row[x] == texels[v * size + y];
+            }
+        }
+    }
+    stats->expectTrue(sampled, "bitmap_swizzled");
+
+    // Drawing into the bitmap, or reading the same memory as a narrower
+    // bitmap, must not sample a tiled copy of the old pixels.
+    auto redrawn = GCreateBitmapShader(bitmap, inverse, GShader::kClamp);
+    redrawn->setContext(GMatrix());
+    for (int i = 0; i < size * size; ++i) {
+        texels[i] = ~texels[i] | GPixel_PackARGB(0xFF, 0, 0, 0);
+    }
+    GBitmap narrower(size - 20, size, size * sizeof(GPixel), texels.data(), true);
+    auto narrowed = GCreateBitmapShader(narrower, inverse, GShader::kClamp);
+
+    bool fresh = true;
+    for (GShader* shader : { redrawn.get(), narrowed.get() }) {
+        shader->setContext(GMatrix());
+        for (int y = 0; y < narrower.width(); y += 37) {
+            shader->shadeRow(0, y, size, row);
+            for (int x = 0; x < size; ++x) {
+                fresh &= row[x] == texels[std::max(0, 298 - x) * size + y];
+            }
+        }
+    }
+    stats->expectTrue(fresh, "bitmap_swizzled_fresh");
+}
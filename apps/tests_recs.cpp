@@ -298,6 +298,7 @@ static void test_matrix_map(GTestStats* stats) {
 #include "tests_pa4.cpp"
 #include "tests_pa5.cpp"
 #include "tests_pa6.cpp"
+#include "tests_final.cpp"
 
 const GTestRec gTestRecs[] = {
     { test_clear,       "clear"         },
@@ -321,6 +322,39 @@ const GTestRec gTestRecs[] = {
     { test_edger_quads, "test_edger_quads"  },
     { test_path_circle, "test_path_circle"  },
 
+    { test_clip_path,   "clip_path"         },
+    { test_layer_clip,  "layer_clip"        },
+    { test_region_ops,  "region_ops"        },
+    { test_clip_rect_difference, "clip_rect_difference" },
+    { test_quick_reject, "quick_reject"     },
+    { test_guard_band_edges, "guard_band_edges" },
+    { test_batch_clip,  "batch_clip"        },
+    { test_path_chop,   "path_chop"         },
+    { test_curve_edges, "curve_edges"       },
+    { test_curve_flatten_scale, "curve_flatten_scale" },
+    { test_path_oval,   "path_oval"         },
+    { test_path_generation_id, "path_generation_id" },
+    { test_edge_cache_offset, "edge_cache_offset" },
+    { test_edge_cache_identical_edges, "edge_cache_identical_edges" },
+    { test_edge_cache_oversized, "edge_cache_oversized" },
+    { test_path_copy_on_write, "path_copy_on_write" },
+    { test_path_metadata, "path_metadata"   },
+    { test_path_builder_arena, "path_builder_arena" },
+    { test_decimate_plot, "decimate_plot"   },
+    { test_stroke, "stroke"   },
+    { test_hairline, "hairline"   },
+    { test_linear_gradient_lut, "linear_gradient_lut" },
+    { test_gradient_stepping, "gradient_stepping" },
+    { test_radial_gradient_tiling, "radial_gradient_tiling" },
+    { test_triangle_gradient, "triangle_gradient" },
+    { test_bitmap_bilinear, "bitmap_bilinear" },
+    { test_bitmap_mipmap, "bitmap_mipmap" },
+    { test_bitmap_mipmap_redraw, "bitmap_mipmap_redraw" },
+    { test_bitmap_translate, "bitmap_translate" },
+    { test_bitmap_tiling_steps, "bitmap_tiling_steps" },
+    { test_bitmap_tiling_wide, "bitmap_tiling_wide" },
+    { test_bitmap_swizzled, "bitmap_swizzled" },
+
     { nullptr, nullptr },
 };
 
@@ -0,0 +1,92 @@
+#ifndef GArena_DEFINED
+#define GArena_DEFINED
+
+#include <cstddef>
+#include <new>
+#include <vector>
+
+/**
+ *  A bump allocator. Allocations are carved out of large blocks and are never freed
+ *  individually; instead reset() makes all of the arena's memory available again at once,
+ *  keeping the blocks around so that the next round of allocations doesn't touch the heap.
+ *
+ *  Nothing allocated from an arena may be used after the arena is reset or destroyed.
+ */
+class GArena {
+public:
+    explicit GArena(size_t blockSize = 1 << 14);
+    ~GArena();
+
+    GArena(const GArena&) = delete;
+    GArena& operator=(const GArena&) = delete;
+
+    /**
+     *  Return size bytes of memory aligned to align, which must be a power of 2.
+     */
+    void* alloc(size_t size, size_t align);
+
+    /**
+     *  Release every allocation at once. The arena's blocks are kept for reuse.
+     */
+    void reset();
+
+    /**
+     *  Return the total size of the blocks the arena holds.
+     */
+    size_t capacity() const;
+
+private:
+    struct Block {
+        char*  fData;
+        size_t fSize;
+    };
+
+    std::vector<Block> fBlocks;
+    size_t fBlockSize;
+    size_t fCurrBlock;  // index of the block allocations are currently taken from
+    size_t fUsed;       // bytes used in the current block
+};
+
+/**
+ *  A standard allocator that takes its memory from an arena, or from the heap if it has no
+ *  arena. Deallocating arena memory does nothing; it is all released by GArena::reset().
+ *
+ *  Copies of a container never inherit the arena, so they can safely outlive it.
+ */
+template <typename T> class GArenaAllocator {
+public:
+    typedef T value_type;
+
+    GArenaAllocator(GArena* arena = nullptr) : fArena(arena) {}
+    template <typename U> GArenaAllocator(const GArenaAllocator<U>& other)
+        : fArena(other.arena()) {}
+
+    T* allocate(size_t n) {
+        if (fArena) {
+            return static_cast<T*>(fArena->alloc(n * sizeof(T), alignof(T)));
+        }
+        return static_cast<T*>(::operator new(n * sizeof(T)));
+    }
+
+    void deallocate(T* p, size_t) {
+        if (!fArena) {
+            ::operator delete(p);
+        }
+    }
+
+    GArenaAllocator select_on_container_copy_construction() const { return GArenaAllocator(); }
+
+    GArena* arena() const { return fArena; }
+
+    template <typename U> bool operator==(const GArenaAllocator<U>& other) const {
+        return fArena == other.arena();
+    }
+    template <typename U> bool operator!=(const GArenaAllocator<U>& other) const {
+        return fArena != other.arena();
+    }
+
+private:
+    GArena* fArena;
+};
+
+#endif
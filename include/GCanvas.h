@@ -7,11 +7,13 @@
 
 #include "GMatrix.h"
 #include "GPaint.h"
+#include "GRegion.h"
 
 class GBitmap;
 class GPath;
 class GPoint;
 class GRect;
+class GStroke;
 
 class GCanvas {
 public:
@@ -111,6 +113,42 @@ public:
      */
     virtual void concat(const GMatrix& matrix) = 0;
 
+    /**
+     *  Intersect the current clip with the specified path (non-zero winding), after it has been
+     *  transformed by the CTM. Subsequent drawing only affects pixels inside the clip, with
+     *  pixels on the clip's edge partially affected by their coverage.
+     *
+     *  Like the CTM, the clip is saved by save() and restored by the balancing call to restore().
+     */
+    virtual void clipPath(const GPath&) = 0;
+
+    enum ClipOp {
+        kIntersect_ClipOp,  // keep only the parts of the clip inside the rect
+        kDifference_ClipOp, // remove the rect from the clip
+    };
+
+    /**
+     *  Combine the current clip with the specified rectangle, after it has been transformed by
+     *  the CTM. When the CTM only scales and translates, the clip stays a region of pixel spans
+     *  and no coverage mask is allocated.
+     */
+    virtual void clipRect(const GRect&, ClipOp = kIntersect_ClipOp) = 0;
+
+    /**
+     *  Intersect the current clip with the specified region. The region is in device coordinates
+     *  (of the current layer), so the CTM is ignored.
+     */
+    virtual void clipRegion(const GRegion&) = 0;
+
+    /**
+     *  Return true if drawing anything inside the specified rectangle (in local coordinates) is
+     *  guaranteed to have no effect, because it falls entirely outside of the clip once it has
+     *  been transformed by the CTM. Callers can use this to skip building geometry entirely.
+     *
+     *  A return value of false does not guarantee that anything will be drawn.
+     */
+    virtual bool quickReject(const GRect&) = 0;
+
     /**
      *  Fill the entire canvas with the specified color, using the specified blendmode.
      */
@@ -134,6 +172,14 @@ public:
      */
     virtual void drawPath(const GPath&, const GPaint&) = 0;
 
+    /**
+     *  Stroke the path with the paint, using the stroke's width, joins and caps. A stroke that is
+     *  no wider than a pixel once transformed by the CTM, including one with a width of 0, is drawn
+     *  as a hairline instead: a line one pixel wide through the path's points, with no joins or
+     *  caps. Unlike filling, open contours are not closed when stroked.
+     */
+    virtual void drawStrokedPath(const GPath&, const GStroke&, const GPaint&) = 0;
+
     // Helpers
 
     void translate(float x, float y) {
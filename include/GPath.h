@@ -1,7 +1,10 @@
 #ifndef GPath_DEFINED
 #define GPath_DEFINED
 
+#include <atomic>
+#include <memory>
 #include <vector>
+#include "GArena.h"
 #include "GPoint.h"
 #include "GRect.h"
 
@@ -10,11 +13,24 @@ class GMatrix;
 class GPath {
 public:
     GPath();
+    GPath(const GPath&) = default;
     ~GPath();
 
     GPath& operator=(const GPath&);
 
+    /**
+     *  Two paths are equal if they contain the same verbs and points.
+     */
+    bool operator==(const GPath&) const;
+    bool operator!=(const GPath& other) const { return !(*this == other); }
+
     GPath& reset();
+
+    /**
+     *  Make room for the path to grow by the given number of points and verbs without
+     *  reallocating its storage.
+     */
+    GPath& reserve(int points, int verbs);
     
     GPath& moveTo(GPoint);
     GPath& moveTo(float x, float y) { return this->moveTo({x, y}); }
@@ -46,16 +62,37 @@ public:
     // moveTo(pts[0]), lineTo(pts[1..count-1])
     GPath& addPolygon(const GPoint pts[], int count);
 
+    /**
+     *  Adds an oval inscribed in the rect as 4 cubics, beginning at the middle of the right edge
+     *  and traversing it in the specified direction.
+     */
+    GPath& addOval(const GRect&, Direction = kCW_Direction);
+
     GPath& addCircle(GPoint center, float radius, Direction = kCW_Direction);
 
-    int countPoints() const { return (int)fPts.size(); }
+    /**
+     *  Return true if the path is exactly one oval, as added by addOval() or addCircle(), and if
+     *  so, set bounds to the rect the oval is inscribed in.
+     */
+    bool isOval(GRect* bounds) const;
+
+    int countPoints() const { return (int)fRef->fPts.size(); }
+
+    /**
+     *  Return an ID that changes whenever the path is modified. Copies of a path share its ID
+     *  until one of them is modified, so the ID can be used to key caches of work derived from
+     *  the path's contents.
+     */
+    uint32_t getGenerationID() const;
 
     /**
      *  Return the bounds of all of the control-points in the path.
      *
      *  If there are no points, return {0, 0, 0, 0}
+     *
+     *  The bounds are kept up to date as points are added, so this is O(1).
      */
-    GRect bounds() const;
+    GRect bounds() const { return fRef->fBounds; }
 
     /**
      *  Transform the path in-place by the specified matrix.
@@ -70,6 +107,21 @@ public:
         kDone   // returns nothing in pts, Iter/Edger is done
     };
 
+    /**
+     *  Return the number of times the verb has been added to the path.
+     */
+    int countVerbs(Verb verb) const { return fRef->fVerbCounts[verb]; }
+
+    /**
+     *  Return true if the path is a single contour that is convex. This is conservative: curves
+     *  are judged by their control points, so a convex curve with a concave control polygon is
+     *  reported as not convex.
+     *
+     *  The result is computed the first time it is asked for, and remembered until the path is
+     *  modified.
+     */
+    bool isConvex() const;
+
     /**
      *  Walks the path, returning each verb that was entered.
      *  e.g.    moveTo() returns kMove
@@ -129,9 +181,86 @@ public:
      */
     static void ChopCubicAt(const GPoint src[4], GPoint dst[7], float t);
 
+    /**
+     *  Subdivide the src[] quadratic at its y-extremum (if it has one strictly between its end
+     *  points) so that each piece is monotonic in y. The pieces share end points, as in
+     *  ChopQuadAt, and the number of pieces (1 or 2) is returned.
+     *
+     *  dst[] must be able to hold 5 points.
+     */
+    static int ChopQuadAtYExtrema(const GPoint src[3], GPoint dst[5]);
+
+    /**
+     *  Subdivide the src[] cubic at its y-extrema so that each piece is monotonic in y. The
+     *  pieces share end points, as in ChopCubicAt, and the number of pieces (1 to 3) is returned.
+     *
+     *  dst[] must be able to hold 10 points.
+     */
+    static int ChopCubicAtYExtrema(const GPoint src[4], GPoint dst[10]);
+
+    /**
+     *  Evaluate the src[] quadratic at each of the count values in t[], storing the resulting
+     *  points in dst[]. The points are computed several at a time with vector instructions.
+     */
+    static void EvalQuadAt(const GPoint src[3], const float t[], GPoint dst[], int count);
+
+    /**
+     *  Evaluate the src[] cubic at each of the count values in t[], storing the resulting points
+     *  in dst[]. The points are computed several at a time with vector instructions.
+     */
+    static void EvalCubicAt(const GPoint src[4], const float t[], GPoint dst[], int count);
+
 private:
-    std::vector<GPoint> fPts;
-    std::vector<Verb>   fVbs;
+    enum Convexity {
+        kUnknown_Convexity,
+        kConvex_Convexity,
+        kConcave_Convexity,
+    };
+
+    /**
+     *  The points and verbs of a path. Copies of a path share the same storage until one of
+     *  them is modified, at which point that path gets a storage of its own.
+     */
+    struct PathRef {
+        explicit PathRef(GArena* arena = nullptr) : fPts(arena), fVbs(arena) {}
+        PathRef(const PathRef&);
+
+        // Storage taken from an arena is only used by the path built into it. Copying a
+        // PathRef always moves its points and verbs back onto the heap.
+        std::vector<GPoint, GArenaAllocator<GPoint>> fPts;
+        std::vector<Verb, GArenaAllocator<Verb>>     fVbs;
+
+        // Kept up to date as points and verbs are appended.
+        GRect               fBounds = GRect::MakeWH(0, 0);
+        int                 fVerbCounts[kDone] = {};
+
+        // Computed lazily by isConvex(). Storage can be shared by paths on different threads,
+        // so these are atomic; any thread computing them gets the same answer.
+        mutable std::atomic<Convexity> fConvexity{kUnknown_Convexity};
+
+        // 0 means an ID has not been assigned since the storage was last modified.
+        mutable std::atomic<uint32_t>  fGenerationID{0};
+
+        void appendPoint(GPoint);
+        void appendVerb(Verb);
+        void computeBounds();
+        void reset();
+    };
+
+    /**
+     *  Return storage that only this path refers to, copying the shared storage first if
+     *  needed. The storage's generation ID is cleared, since the caller is about to modify it.
+     */
+    PathRef* writableRef();
+
+    /**
+     *  Every empty path shares the same storage, so constructing one doesn't allocate.
+     */
+    static const std::shared_ptr<PathRef>& EmptyRef();
+
+    std::shared_ptr<PathRef> fRef;
+
+    friend class GPathBuilder;
 };
 
 #endif
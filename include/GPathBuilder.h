@@ -0,0 +1,72 @@
+#ifndef GPathBuilder_DEFINED
+#define GPathBuilder_DEFINED
+
+#include "GArena.h"
+#include "GPath.h"
+
+/**
+ *  Builds paths whose storage comes from an arena, for scenes that rebuild many paths every
+ *  frame. Once the arena has grown to hold a whole frame, resetting it at the start of the next
+ *  frame lets every path be built without touching the heap.
+ *
+ *      arena.reset();
+ *      GPathBuilder builder(&arena);
+ *      GPath path = builder.addPolygon(pts, count).detach();
+ *
+ *  Paths built this way must not outlive the arena, or the arena's next reset. Copies of them
+ *  are safe: the first modification of a copy moves its storage to the heap.
+ */
+class GPathBuilder {
+public:
+    /**
+     *  If arena is null, paths are built on the heap, just like GPath.
+     */
+    explicit GPathBuilder(GArena* arena = nullptr);
+
+    GPathBuilder& reserve(int points, int verbs);
+
+    GPathBuilder& moveTo(GPoint p) { fPath.moveTo(p); return *this; }
+    GPathBuilder& moveTo(float x, float y) { return this->moveTo({x, y}); }
+
+    GPathBuilder& lineTo(GPoint p) { fPath.lineTo(p); return *this; }
+    GPathBuilder& lineTo(float x, float y) { return this->lineTo({x, y}); }
+
+    GPathBuilder& quadTo(GPoint p1, GPoint p2) { fPath.quadTo(p1, p2); return *this; }
+    GPathBuilder& quadTo(float x0, float y0, float x1, float y1) {
+        return this->quadTo({x0, y0}, {x1, y1});
+    }
+
+    GPathBuilder& cubicTo(GPoint p1, GPoint p2, GPoint p3) {
+        fPath.cubicTo(p1, p2, p3);
+        return *this;
+    }
+    GPathBuilder& cubicTo(float x0, float y0, float x1, float y1, float x2, float y2) {
+        return this->cubicTo({x0, y0}, {x1, y1}, {x2, y2});
+    }
+
+    GPathBuilder& addRect(const GRect& r, GPath::Direction dir = GPath::kCW_Direction) {
+        fPath.addRect(r, dir);
+        return *this;
+    }
+    GPathBuilder& addPolygon(const GPoint pts[], int count) {
+        fPath.addPolygon(pts, count);
+        return *this;
+    }
+    GPathBuilder& addOval(const GRect& r, GPath::Direction dir = GPath::kCW_Direction) {
+        fPath.addOval(r, dir);
+        return *this;
+    }
+
+    /**
+     *  Return the path built so far, and start building a new, empty one.
+     */
+    GPath detach();
+
+private:
+    void startPath();
+
+    GArena* fArena;
+    GPath   fPath;
+};
+
+#endif
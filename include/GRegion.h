@@ -0,0 +1,76 @@
+#ifndef GRegion_DEFINED
+#define GRegion_DEFINED
+
+#include <vector>
+#include "GRect.h"
+
+/**
+ *  A set of pixels described as horizontal bands, each holding a sorted list of disjoint spans.
+ *  This is the same structure a scanline region uses, which makes it cheap to combine regions
+ *  built from rectangles and to look up which parts of a row are inside the region.
+ */
+class GRegion {
+public:
+    struct Span {
+        int32_t fLeft;
+        int32_t fRight;
+
+        bool operator==(const Span& s) const { return fLeft == s.fLeft && fRight == s.fRight; }
+    };
+
+    enum Op {
+        kUnion_Op,          // pixels in either region
+        kIntersect_Op,      // pixels in both regions
+        kDifference_Op,     // pixels in this region but not the other
+    };
+
+    /**
+     *  Create an empty region.
+     */
+    GRegion() {}
+
+    /**
+     *  Create a region covering a single rectangle.
+     */
+    explicit GRegion(const GIRect&);
+
+    bool isEmpty() const { return fBands.empty(); }
+
+    /**
+     *  Return the smallest rectangle containing the region, or {0, 0, 0, 0} if it is empty.
+     */
+    GIRect getBounds() const;
+
+    bool contains(int x, int y) const;
+
+    void translate(int dx, int dy);
+
+    /**
+     *  Replace this region with the result of combining it with another region.
+     */
+    void op(const GRegion&, Op);
+    void op(const GIRect& rect, Op o) { this->op(GRegion(rect), o); }
+
+    /**
+     *  Return the spans covering row y, sorted from left to right, and set count to the number
+     *  of them. If the row is outside the region, this returns null and sets count to 0.
+     *
+     *  This is a binary search over the bands, so it is O(log n).
+     */
+    const Span* getRow(int y, int* count) const;
+
+private:
+    struct Band {
+        int32_t fTop;
+        int32_t fBottom;
+        int     fSpanStart;
+        int     fSpanCount;
+    };
+
+    void appendBand(int top, int bottom, const std::vector<Span>& spans);
+
+    std::vector<Band> fBands;
+    std::vector<Span> fSpans;
+};
+
+#endif
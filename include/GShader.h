@@ -24,6 +24,11 @@ public:
         kMirror,
     };
 
+    enum FilterQuality {
+        kNearest,   // each pixel takes the color of the nearest texel
+        kBilinear,  // each pixel blends the four texels around it by distance
+    };
+
     virtual ~GShader() {}
 
     // Return true iff all of the GPixels that may be returned by this shader will be opaque.
@@ -43,9 +48,13 @@ public:
 /**
  *  Return a subclass of GShader that draws the specified bitmap and the inverse of a local matrix.
  *  Returns null if the either parameter is invalid.
+ *
+ *  The filter quality decides how the bitmap is sampled between its texels. Bilinear filtering
+ *  keeps scaled and rotated bitmaps from shimmering, at some extra cost per pixel.
  */
 std::unique_ptr<GShader> GCreateBitmapShader(const GBitmap&, const GMatrix& localInv,
-                                             GShader::TileMode = GShader::kClamp);
+                                             GShader::TileMode = GShader::kClamp,
+                                             GShader::FilterQuality = GShader::kNearest);
 
 /**
  *  Return a subclass of GShader that draws the specified gradient of [count] colors between
@@ -68,4 +77,15 @@ static inline std::unique_ptr<GShader> GCreateLinearGradient(GPoint p0, GPoint p
     return GCreateLinearGradient(p0, p1, colors, 2, mode);
 }
 
+/**
+ *  Return a radial gradient shader, with colors[0] at the center and colors[count-1] at the
+ *  radius, evenly spaced in between. Beyond the radius the gradient is clamped, repeated or
+ *  mirrored according to the tile mode.
+ *
+ *  If count == 1, the returned shader just draws a single color everywhere.
+ *  If count < 1 or radius <= 0, this returns nullptr.
+ */
+std::unique_ptr<GShader> GCreateRadialGradient(GPoint center, float radius, const GColor[],
+                                               int count, GShader::TileMode = GShader::kClamp);
+
 #endif
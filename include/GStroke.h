@@ -0,0 +1,56 @@
+#ifndef GStroke_DEFINED
+#define GStroke_DEFINED
+
+#include "GPath.h"
+
+/**
+ *  Describes how to stroke a path, and turns paths into fillable outlines of their strokes.
+ */
+class GStroke {
+public:
+    enum Join {
+        kMiter_Join,    // extend the outer edges until they meet, within the miter limit
+        kRound_Join,    // round the outer corner with an arc centered on the point
+        kBevel_Join,    // connect the outer edges with a straight line
+    };
+
+    enum Cap {
+        kButt_Cap,      // end the stroke exactly at the end point
+        kRound_Cap,     // end the stroke with a half circle centered on the end point
+        kSquare_Cap,    // extend the stroke past the end point by half its width
+    };
+
+    /**
+     *  Width is the distance from one side of the stroke to the other. A miter whose length
+     *  (measured from the point to its tip) would be more than miterLimit times half the width
+     *  is drawn as a bevel instead.
+     */
+    explicit GStroke(float width, Join join = kMiter_Join, Cap cap = kButt_Cap,
+                     float miterLimit = 4)
+        : fWidth(width), fJoin(join), fCap(cap), fMiterLimit(miterLimit) {}
+
+    float width() const { return fWidth; }
+    Join join() const { return fJoin; }
+    Cap cap() const { return fCap; }
+    float miterLimit() const { return fMiterLimit; }
+
+    /**
+     *  Append the outline of each of src's contours, stroked, to dst, so that filling dst draws
+     *  the stroke. An open contour becomes a single closed contour. A contour whose last point
+     *  is its first is treated as closed: it gets a join there instead of caps, and becomes two
+     *  contours, one for each side of the stroke.
+     *
+     *  Curves are flattened into lines before they are stroked, close enough to stay within a
+     *  quarter pixel of the curve on screen. scale is the most that one unit of src is stretched
+     *  by the matrix dst will be drawn with (1 if it is drawn untransformed).
+     */
+    void strokePath(const GPath& src, GPath* dst, float scale = 1) const;
+
+private:
+    float fWidth;
+    Join  fJoin;
+    Cap   fCap;
+    float fMiterLimit;
+};
+
+#endif
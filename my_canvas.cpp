@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <deque>
+#include <list>
 #include <math.h>
 #include <stack>
 
@@ -13,12 +16,17 @@
 #include "GPoint.h"
 #include "GRadialGradient.h"
 #include "GRect.h"
+#include "GRegion.h"
 #include "GScanConverter.h"
 #include "GShader.h"
+#include "GStroke.h"
+#include "GTriangleGradient.h"
 
 #include "Blend.h"
 #include "Clipper.h"
 #include "ColorUtils.h"
+#include "EdgeBuilder.h"
+#include "GClipMask.h"
 #include "MathUtils.h"
 
 
@@ -33,6 +41,91 @@ public:
         mLayers.push(GLayer(&device, identity, bounds));
     }
 
+    /**
+     * Intersect the current clip with a path. The path is rasterized into a
+     * coverage mask the size of the current layer, which is then used to
+     * modulate every draw until the clip is restored.
+     */
+    void clipPath(const GPath& path) override {
+        GLayer& layer = mLayers.top();
+
+        std::shared_ptr<const GClipMask> mask = this->getPathMask(
+            path,
+            layer.getCTM(),
+            layer.getBitmap().width(),
+            layer.getBitmap().height());
+
+        if (layer.getClipMask() != nullptr) {
+            std::shared_ptr<GClipMask> combined(new GClipMask(*layer.getClipMask()));
+            combined->intersect(*mask);
+            mask = combined;
+        }
+
+        layer.setClipMask(mask);
+    }
+
+    /**
+     * Combine the clip with a rectangle. As long as the CTM keeps the
+     * rectangle axis-aligned, this is done with the clip region. Otherwise we
+     * fall back to a coverage mask.
+     */
+    void clipRect(const GRect& rect, ClipOp op) override {
+        GLayer& layer = mLayers.top();
+        GMatrix ctm = layer.getCTM();
+
+        if (ctm[GMatrix::KX] == 0 && ctm[GMatrix::KY] == 0) {
+            GPoint corners[2] = {
+                GPoint::Make(rect.left(), rect.top()),
+                GPoint::Make(rect.right(), rect.bottom())
+            };
+            ctm.mapPoints(corners, corners, 2);
+
+            GRect deviceRect = GRect::MakeLTRB(
+                std::min(corners[0].fX, corners[1].fX),
+                std::min(corners[0].fY, corners[1].fY),
+                std::max(corners[0].fX, corners[1].fX),
+                std::max(corners[0].fY, corners[1].fY));
+
+            std::shared_ptr<GRegion> region = this->copyClipRegion(layer);
+            region->op(
+                deviceRect.round(),
+                op == kIntersect_ClipOp ? GRegion::kIntersect_Op : GRegion::kDifference_Op);
+
+            layer.setClipRegion(region);
+            return;
+        }
+
+        GPath path;
+        path.addRect(rect);
+
+        if (op == kIntersect_ClipOp) {
+            this->clipPath(path);
+            return;
+        }
+
+        std::shared_ptr<GClipMask> mask(new GClipMask(*this->getPathMask(
+            path,
+            ctm,
+            layer.getBitmap().width(),
+            layer.getBitmap().height())));
+        mask->invert();
+
+        if (layer.getClipMask() != nullptr) {
+            mask->intersect(*layer.getClipMask());
+        }
+
+        layer.setClipMask(mask);
+    }
+
+    void clipRegion(const GRegion& region) override {
+        GLayer& layer = mLayers.top();
+
+        std::shared_ptr<GRegion> combined = this->copyClipRegion(layer);
+        combined->op(region, GRegion::kIntersect_Op);
+
+        layer.setClipRegion(combined);
+    }
+
     void concat(const GMatrix& matrix) override {
         mLayers.top().getCTM().preConcat(matrix);
     }
@@ -43,6 +136,10 @@ public:
      * new polygon is drawn with respect to the pixels already on the screen.
      */
     void drawConvexPolygon(const GPoint srcPoints[], int count, const GPaint& paint) override {
+        if (count < 3 || this->quickReject(pointBounds(srcPoints, count))) {
+            return;
+        }
+
         GLayer layer = mLayers.top();
 
         // If the paint has a shader and we can't set its context, we can't
@@ -55,9 +152,7 @@ public:
         GPoint points[count];
         layer.getCTM().mapPoints(points, srcPoints, count);
 
-        GRect bounds = GRect::MakeWH(
-            layer.getBitmap().width(),
-            layer.getBitmap().height());
+        GRect bounds = this->getClipBounds(layer);
         Edge storage[count * 3];
         Edge* edge = storage;
 
@@ -65,7 +160,7 @@ public:
             GPoint p0 = points[i];
             GPoint p1 = points[(i + 1) % count];
 
-            edge = clipLine(p0, p1, bounds, edge);
+            edge = clipLineToGuardBand(p0, p1, bounds, edge);
         }
 
         int edgeCount = edge - storage;
@@ -73,9 +168,13 @@ public:
             return;
         }
 
-        GBlitter blitter = GBlitter(layer.getBitmap(), paint);
+        GPaintBlitter blitter = GPaintBlitter(
+            layer.getBitmap(),
+            paint,
+            layer.getClipMask().get(),
+            layer.getClipRegion().get());
 
-        GScanConverter::scan(storage, edgeCount, blitter);
+        GScanConverter::scan(storage, edgeCount, nullptr, blitter);
     }
 
     /**
@@ -88,6 +187,10 @@ public:
     }
 
     void drawPath(const GPath& path, const GPaint& paint) override {
+        if (this->quickReject(path.bounds())) {
+            return;
+        }
+
         GLayer layer = mLayers.top();
 
         // If the paint has a shader and we can't set its context, we can't
@@ -97,63 +200,36 @@ public:
             return;
         }
 
-        GPoint points[6 * path.countPoints()];
-        int edgeCount = 0;
-        GPath::Edger edger = GPath::Edger(path);
+        GMatrix ctm = layer.getCTM();
+        GRect clipBounds = this->getClipBounds(layer);
 
-        GPath::Verb verb;
-        do {
-            GPoint nextPts[4];
-            verb = edger.next(nextPts);
-
-            if (verb == GPath::Verb::kLine) {
-                points[2 * edgeCount] = nextPts[0];
-                points[2 * edgeCount + 1] = nextPts[1];
-                edgeCount++;
-            } else if (verb == GPath::Verb::kCubic) {
-                points[2 * edgeCount] = nextPts[0];
-                points[2 * edgeCount + 1] = nextPts[1];
-                edgeCount++;
-                points[2 * edgeCount] = nextPts[1];
-                points[2 * edgeCount + 1] = nextPts[2];
-                edgeCount++;
-                points[2 * edgeCount] = nextPts[2];
-                points[2 * edgeCount + 1] = nextPts[3];
-                edgeCount++;
-            } else if (verb == GPath::Verb::kQuad) {
-                points[2 * edgeCount] = nextPts[0];
-                points[2 * edgeCount + 1] = nextPts[1];
-                edgeCount++;
-                points[2 * edgeCount] = nextPts[1];
-                points[2 * edgeCount + 1] = nextPts[2];
-                edgeCount++;
-            }
-        } while (verb != GPath::Verb::kDone);
-
-        layer.getCTM().mapPoints(points, points, 2 * edgeCount);
-
-        GRect bounds = GRect::MakeWH(
-            layer.getBitmap().width(),
-            layer.getBitmap().height());
-        Edge storage[3 * edgeCount];
-        Edge* edge = storage;
+        GPaintBlitter blitter = GPaintBlitter(
+            layer.getBitmap(),
+            paint,
+            layer.getClipMask().get(),
+            layer.getClipRegion().get());
 
-        for (int i = 0; i < edgeCount; ++i) {
-            GPoint p0 = points[2 * i];
-            GPoint p1 = points[2 * i + 1];
-
-            edge = clipLine(p0, p1, bounds, edge);
+        // An oval stays an axis-aligned oval under a scale and translate, so
+        // it can be filled directly without building any edges.
+        GRect oval;
+        if (ctm[GMatrix::KX] == 0 && ctm[GMatrix::KY] == 0 && path.isOval(&oval)) {
+            fillOval(mapRect(ctm, oval), clipBounds, blitter);
+            return;
         }
 
-        // Recalculate edge count after clipping
-        edgeCount = edge - storage;
-        if (edgeCount == 0) {
+        PathEdges built = this->getPathEdges(path, ctm, clipBounds);
+        std::vector<Edge>& edges = built.edges;
+        if (edges.size() == 0) {
             return;
         }
 
-        GBlitter blitter = GBlitter(layer.getBitmap(), paint);
-
-        GScanConverter::scanComplex(storage, edgeCount, blitter);
+        // A convex path is still convex after any affine transform, so it can
+        // use the simpler scan converter that never tracks winding.
+        if (path.isConvex()) {
+            GScanConverter::scan(edges.data(), edges.size(), built.curves.data(), blitter);
+        } else {
+            GScanConverter::scanComplex(edges.data(), edges.size(), built.curves.data(), blitter);
+        }
     }
 
     /**
@@ -170,21 +246,53 @@ public:
         drawConvexPolygon(points, 4, paint);
     }
 
-    void final_addStrokedLine(GPath* path, GPoint p0, GPoint p1, float width, bool roundCap) {
-        float slope = (p1.fY - p0.fY) / (p1.fX - p0.fX);
-        float perp = 1 / -slope;
+    /**
+     * Stroke a path. Strokes no wider than a pixel on screen are drawn as
+     * hairlines straight from the path's points, without building an outline
+     * or any edges.
+     */
+    void drawStrokedPath(const GPath& path, const GStroke& stroke, const GPaint& paint) override {
+        GLayer layer = mLayers.top();
+        GMatrix ctm = layer.getCTM();
 
-        float corner_angle = atan(perp);
+        if (stroke.width() * maxScale(ctm) > 1) {
+            GPath outline;
+            stroke.strokePath(path, &outline, maxScale(ctm));
+            this->drawPath(outline, paint);
+            return;
+        }
+
+        // A hairline reaches at most a pixel past the path's points.
+        GRect clipBounds = this->getClipBounds(layer);
+        GRect deviceBounds = mapRect(ctm, path.bounds());
+        deviceBounds = GRect::MakeLTRB(deviceBounds.left() - 1, deviceBounds.top() - 1,
+                                       deviceBounds.right() + 1, deviceBounds.bottom() + 1);
+        if (path.countPoints() == 0 || !deviceBounds.intersects(clipBounds)) {
+            return;
+        }
 
-        float corner_dx = cos(corner_angle) * width / 2;
-        float corner_dy = sin(corner_angle) * width / 2;
+        // If the paint has a shader and we can't set its context, we can't
+        // draw anything.
+        if (paint.getShader() != nullptr
+                && !paint.getShader()->setContext(ctm)) {
+            return;
+        }
 
-        GPoint c0 = GPoint::Make(p0.fX + corner_dx, p0.fY + corner_dy);
-        GPoint c1 = GPoint::Make(p0.fX - corner_dx, p0.fY - corner_dy);
-        GPoint c2 = GPoint::Make(p1.fX - corner_dx, p1.fY - corner_dy);
-        GPoint c3 = GPoint::Make(p1.fX + corner_dx, p1.fY + corner_dy);
+        GPaintBlitter blitter = GPaintBlitter(
+            layer.getBitmap(),
+            paint,
+            layer.getClipMask().get(),
+            layer.getClipRegion().get());
 
-        path->moveTo(c0).lineTo(c1).lineTo(c2).lineTo(c3);
+        hairlinePath(path, ctm, clipBounds, blitter);
+    }
+
+    void final_addStrokedLine(GPath* path, GPoint p0, GPoint p1, float width, bool roundCap) override {
+        GPath line;
+        line.moveTo(p0).lineTo(p1);
+
+        GStroke stroke(width, GStroke::kMiter_Join, roundCap ? GStroke::kRound_Cap : GStroke::kButt_Cap);
+        stroke.strokePath(line, path);
     }
 
     std::unique_ptr<GShader> final_createRadialGradient(GPoint center, float radius, const GColor colors[], int count) override {
@@ -195,32 +303,30 @@ public:
         return std::unique_ptr<GShader>(new GRadialGradient(center, radius, colors, count));
     }
 
+    std::unique_ptr<GShader> final_createTriangleGradient(const GPoint pts[3], const GColor colors[3]) override {
+        return std::unique_ptr<GShader>(new GTriangleGradient(pts, colors));
+    }
+
+    /**
+     * Determine if anything drawn inside a rectangle would be clipped away.
+     * The rectangle is mapped through the CTM and compared against the layer
+     * and clip bounds.
+     */
+    bool quickReject(const GRect& rect) override {
+        GLayer& layer = mLayers.top();
+
+        GRect deviceRect = mapRect(layer.getCTM(), rect);
+
+        return !deviceRect.intersects(this->getClipBounds(layer));
+    }
+
     void onSaveLayer(const GRect* boundsPtr, const GPaint& paint) override {
         GIRect bounds;
         GIRect prevBounds = mLayers.top().getBounds();
         if (boundsPtr == nullptr) {
             bounds = GIRect::MakeWH(prevBounds.width(), prevBounds.height());
         } else {
-            GPoint points[4] = {
-                GPoint::Make(boundsPtr->left(), boundsPtr->top()),
-                GPoint::Make(boundsPtr->right(), boundsPtr->top()),
-                GPoint::Make(boundsPtr->right(), boundsPtr->bottom()),
-                GPoint::Make(boundsPtr->left(), boundsPtr->bottom())
-            };
-            mLayers.top().getCTM().mapPoints(points, points, 4);
-
-            float xVals[4], yVals[4];
-            for (int i = 0; i < 4; ++i) {
-                xVals[i] = points[i].fX;
-                yVals[i] = points[i].fY;
-            }
-
-            float left = manyMin(xVals, 4);
-            float top = manyMin(yVals, 4);
-            float right = manyMax(xVals, 4);
-            float bottom = manyMax(yVals, 4);
-
-            GRect floatBounds = GRect::MakeLTRB(left, top, right, bottom);
+            GRect floatBounds = mapRect(mLayers.top().getCTM(), *boundsPtr);
             bounds = floatBounds.round();
 
             if (!bounds.intersect(prevBounds)) {
@@ -248,6 +354,26 @@ public:
             prevBounds.top() - bounds.top());
 
         GLayer newLayer = GLayer(bitmap, newCTM, bounds, paint);
+
+        // The clip carries over into the new layer, offset the same way as
+        // the CTM.
+        if (mLayers.top().getClipMask() != nullptr) {
+            std::shared_ptr<GClipMask> mask(new GClipMask(bounds.width(), bounds.height()));
+            mask->copyFrom(
+                *mLayers.top().getClipMask(),
+                prevBounds.left() - bounds.left(),
+                prevBounds.top() - bounds.top());
+
+            newLayer.setClipMask(mask);
+        }
+
+        if (mLayers.top().getClipRegion() != nullptr) {
+            std::shared_ptr<GRegion> region(new GRegion(*mLayers.top().getClipRegion()));
+            region->translate(prevBounds.left() - bounds.left(), prevBounds.top() - bounds.top());
+
+            newLayer.setClipRegion(region);
+        }
+
         mLayers.push(newLayer);
     }
 
@@ -256,18 +382,416 @@ public:
         mLayers.pop();
         GLayer base = mLayers.top();
 
+        // Compositing the layer is a draw to the base, so it is clipped the
+        // same way.
         if (top.isLayer()) {
-            top.draw(&base.getBitmap());
+            top.draw(&base.getBitmap(), base.getClipMask().get(), base.getClipRegion().get());
         }
     }
 
     void save() override {
         GLayer current = mLayers.top();
-        mLayers.push(GLayer(&current.getBitmap(), current.getCTM(), current.getBounds()));
+        GLayer saved = GLayer(&current.getBitmap(), current.getCTM(), current.getBounds());
+        saved.setClipMask(current.getClipMask());
+        saved.setClipRegion(current.getClipRegion());
+
+        mLayers.push(saved);
     }
 
 private:
+    /**
+     * Map a rectangle through a matrix.
+     *
+     * Returns:
+     *     The bounds of the mapped rectangle.
+     */
+    static GRect mapRect(const GMatrix& matrix, const GRect& rect) {
+        GPoint points[4] = {
+            GPoint::Make(rect.left(), rect.top()),
+            GPoint::Make(rect.right(), rect.top()),
+            GPoint::Make(rect.right(), rect.bottom()),
+            GPoint::Make(rect.left(), rect.bottom())
+        };
+
+        return pointBounds(points, 4, &matrix);
+    }
+
+    /**
+     * Fill an axis-aligned oval by solving for the span it covers on each row,
+     * sampling at pixel centers just like the scan converter does.
+     *
+     * Args:
+     *     oval:
+     *         The device space rectangle the oval is inscribed in.
+     *     clipBounds:
+     *         The device space rectangle that drawing is limited to.
+     *     blitter:
+     *         The blitter used to draw each row.
+     */
+    static void fillOval(const GRect& oval, const GRect& clipBounds, GBlitter& blitter) {
+        float cx = (oval.left() + oval.right()) / 2;
+        float cy = (oval.top() + oval.bottom()) / 2;
+        float rx = oval.width() / 2;
+        float ry = oval.height() / 2;
+
+        int top = GRoundToInt(std::max(oval.top(), clipBounds.top()));
+        int bottom = GRoundToInt(std::min(oval.bottom(), clipBounds.bottom()));
+
+        for (int y = top; y < bottom; ++y) {
+            float dy = (y + 0.5f - cy) / ry;
+            float dx = rx * sqrtf(std::max(0.0f, 1 - dy * dy));
+
+            int left = GRoundToInt(cx - dx);
+            int right = GRoundToInt(cx + dx);
+            if (left < right) {
+                blitter.blitRow(y, left, right);
+            }
+        }
+    }
+
+    /**
+     * Decide how far line segments may be moved by merging them while
+     * building a path's edges. Merging only pays off for paths, like plots of
+     * sampled data, with far more segments than their size on screen has
+     * room to show, so every other path is left exact.
+     *
+     * Returns:
+     *     The decimation tolerance to build the path's edges with, where 0
+     *     turns decimation off.
+     */
+    static float decimateTolerance(const GPath& path, const GRect& deviceBounds) {
+        float perimeter = 2 * (deviceBounds.width() + deviceBounds.height());
+
+        return path.countVerbs(GPath::kLine) > perimeter ? kDefaultDecimateTolerance : 0;
+    }
+
+    /**
+     * Draw each contour of a path as a hairline, flattening its curves in
+     * device space.
+     *
+     * Args:
+     *     path:
+     *         The path to draw.
+     *     ctm:
+     *         The matrix used to map the path's points into device space.
+     *     clipBounds:
+     *         The device space rectangle that drawing is limited to.
+     *     blitter:
+     *         The blitter used to draw each pixel.
+     */
+    static void hairlinePath(const GPath& path, const GMatrix& ctm, const GRect& clipBounds,
+                             GBlitter& blitter) {
+        std::vector<GPoint> contour;
+        contour.reserve(path.countPoints());
+
+        GPath::Iter iter(path);
+        GPoint pts[4];
+        GPath::Verb verb;
+
+        while ((verb = iter.next(pts)) != GPath::kDone) {
+            switch (verb) {
+                case GPath::kMove:
+                    GScanConverter::hairline(contour.data(), contour.size(), clipBounds, blitter);
+                    contour.clear();
+                    contour.push_back(ctm.mapPt(pts[0]));
+                    break;
+                case GPath::kLine:
+                    contour.push_back(ctm.mapPt(pts[1]));
+                    break;
+                case GPath::kQuad:
+                    ctm.mapPoints(pts, 3);
+                    flattenCurve(pts, 3, kDefaultFlattenTolerance, contour);
+                    break;
+                case GPath::kCubic:
+                    ctm.mapPoints(pts, 4);
+                    flattenCurve(pts, 4, kDefaultFlattenTolerance, contour);
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        GScanConverter::hairline(contour.data(), contour.size(), clipBounds, blitter);
+    }
+
+    /**
+     * Find the most that a matrix can stretch any vector, which is its
+     * largest singular value.
+     */
+    static float maxScale(const GMatrix& matrix) {
+        float a = matrix[GMatrix::SX];
+        float b = matrix[GMatrix::KX];
+        float c = matrix[GMatrix::KY];
+        float d = matrix[GMatrix::SY];
+
+        float sum = a * a + b * b + c * c + d * d;
+        float det = a * d - b * c;
+
+        return sqrtf((sum + sqrtf(std::max(0.0f, sum * sum - 4 * det * det))) / 2);
+    }
+
+    /**
+     * Get the bounds of a set of points, optionally mapping them through a
+     * matrix first.
+     */
+    static GRect pointBounds(const GPoint points[], int count, const GMatrix* matrix = nullptr) {
+        float xVals[count], yVals[count];
+        for (int i = 0; i < count; ++i) {
+            GPoint point = points[i];
+            if (matrix != nullptr) {
+                point = matrix->mapPt(point);
+            }
+
+            xVals[i] = point.fX;
+            yVals[i] = point.fY;
+        }
+
+        return GRect::MakeLTRB(
+            manyMin(xVals, count),
+            manyMin(yVals, count),
+            manyMax(xVals, count),
+            manyMax(yVals, count));
+    }
+
+    /**
+     * A rasterized clip path, along with the state it was rasterized for.
+     */
+    struct MaskCacheEntry {
+        uint32_t pathID;
+        GMatrix ctm;
+        int width;
+        int height;
+        std::shared_ptr<const GClipMask> mask;
+    };
+
+    // The number of clip masks we hold on to between draws.
+    static const int kMaskCacheSize = 8;
+
+    /**
+     * The sorted, unclipped edges of a path, built for a CTM whose
+     * translation has been factored out.
+     */
+    struct EdgeCacheEntry {
+        uint32_t pathID;
+        GMatrix ctm;
+        PathEdges edges;
+
+        size_t bytes() const {
+            return this->edges.edges.size() * sizeof(Edge)
+                + this->edges.curves.size() * sizeof(CurveEdge);
+        }
+    };
+
+    // The most memory we spend on holding on to path edges between draws.
+    static const size_t kEdgeCacheBudget = 1 << 20;
+
+    // The number of paths drawn once that we remember, so that their edges
+    // are cached if they are drawn again.
+    static const size_t kSeenPathCount = 64;
+
+    /**
+     * Get the device space rectangle that drawing to a layer is limited to.
+     */
+    GRect getClipBounds(GLayer& layer) {
+        GIRect bounds = GIRect::MakeWH(layer.getBitmap().width(), layer.getBitmap().height());
+
+        if (layer.getClipMask() != nullptr
+                && !bounds.intersect(layer.getClipMask()->getBounds())) {
+            return GRect::MakeWH(0, 0);
+        }
+
+        if (layer.getClipRegion() != nullptr
+                && !bounds.intersect(layer.getClipRegion()->getBounds())) {
+            return GRect::MakeWH(0, 0);
+        }
+
+        return GRect::Make(bounds);
+    }
+
+    /**
+     * Make a copy of a layer's clip region that can be modified. If the layer
+     * has no region yet, the copy covers the whole layer.
+     */
+    std::shared_ptr<GRegion> copyClipRegion(GLayer& layer) {
+        if (layer.getClipRegion() != nullptr) {
+            return std::shared_ptr<GRegion>(new GRegion(*layer.getClipRegion()));
+        }
+
+        GIRect bounds = GIRect::MakeWH(layer.getBitmap().width(), layer.getBitmap().height());
+
+        return std::shared_ptr<GRegion>(new GRegion(bounds));
+    }
+
+    /**
+     * Get the coverage mask for a clip path. Masks are cached by the path's
+     * generation ID and the CTM, so clipping to the same path every frame only rasterizes it once.
+     * The cache is kept in most-recently-used order.
+     */
+    std::shared_ptr<const GClipMask> getPathMask(
+            const GPath& path,
+            GMatrix ctm,
+            int width,
+            int height) {
+        for (auto it = mMaskCache.begin(); it != mMaskCache.end(); ++it) {
+            if (it->width == width && it->height == height && it->ctm == ctm
+                    && it->pathID == path.getGenerationID()) {
+                mMaskCache.splice(mMaskCache.begin(), mMaskCache, it);
+
+                return it->mask;
+            }
+        }
+
+        std::shared_ptr<const GClipMask> mask(new GClipMask(path, ctm, width, height));
+        mMaskCache.push_front({ path.getGenerationID(), ctm, width, height, mask });
+
+        if (mMaskCache.size() > kMaskCacheSize) {
+            mMaskCache.pop_back();
+        }
+
+        return mask;
+    }
+
+    /**
+     * Get the edges of a path, clipped vertically to the clip bounds.
+     *
+     * Edges are cached by the path's generation ID and the CTM without its
+     * translation, so drawing the same path again, even somewhere else, skips
+     * building and sorting its edges. Any horizontal offset and whole-row
+     * vertical offsets can be applied to the cached edges exactly, so only the
+     * fractional part of the vertical translation is part of the key. The
+     * cache is kept in most-recently-used order and is limited to
+     * 'kEdgeCacheBudget' bytes of edges.
+     *
+     * Cached edges are built without knowing the clip, so they are only used
+     * for paths that lie entirely inside it. Paths that cross the clip are
+     * built against it instead, which culls curves that can't be seen and
+     * clips edges that leave the guard band. A path is also only cached the
+     * second time it is drawn, so paths that are drawn once, like stroke
+     * outlines, don't push out the ones that are drawn again and again.
+     */
+    PathEdges getPathEdges(const GPath& path, const GMatrix& ctm, const GRect& clipBounds) {
+        GRect deviceBounds = mapRect(ctm, path.bounds());
+        if (!deviceBounds.intersects(clipBounds)) {
+            return PathEdges();
+        }
+
+        float decimate = decimateTolerance(path, deviceBounds);
+        if (!clipBounds.contains(deviceBounds)) {
+            return buildPathEdges(path, ctm, clipBounds, kDefaultFlattenTolerance, decimate);
+        }
+
+        float dx = ctm[GMatrix::TX];
+        float dy = floorf(ctm[GMatrix::TY]);
+
+        GMatrix key = GMatrix(
+            ctm[GMatrix::SX], ctm[GMatrix::KX], 0,
+            ctm[GMatrix::KY], ctm[GMatrix::SY], ctm[GMatrix::TY] - dy);
+        uint32_t pathID = path.getGenerationID();
+
+        auto it = mEdgeCache.begin();
+        while (it != mEdgeCache.end() && !(it->pathID == pathID && it->ctm == key)) {
+            ++it;
+        }
+
+        if (it != mEdgeCache.end()) {
+            mEdgeCache.splice(mEdgeCache.begin(), mEdgeCache, it);
+        } else {
+            if (!this->seenPathBefore(pathID)) {
+                return buildPathEdges(path, ctm, clipBounds, kDefaultFlattenTolerance, decimate);
+            }
+
+            // The cached edges are only clipped to the path itself, so they
+            // can be reused wherever the path ends up inside the clip.
+            EdgeCacheEntry entry = {
+                pathID,
+                key,
+                buildPathEdges(path, key, mapRect(key, path.bounds()),
+                               kDefaultFlattenTolerance, decimate)
+            };
+
+            // Edges too big to ever fit in the cache are still good for this
+            // draw, once they're moved into place.
+            if (entry.bytes() > kEdgeCacheBudget) {
+                placeEdges(&entry.edges, dx, (int) dy, clipBounds);
+                return std::move(entry.edges);
+            }
+
+            std::sort(entry.edges.edges.begin(), entry.edges.edges.end());
+
+            mEdgeCacheBytes += entry.bytes();
+            mEdgeCache.push_front(std::move(entry));
+
+            while (mEdgeCacheBytes > kEdgeCacheBudget) {
+                mEdgeCacheBytes -= mEdgeCache.back().bytes();
+                mEdgeCache.pop_back();
+            }
+        }
+
+        // Curves are stepped as their edges are drawn, so each draw gets its
+        // own copy of them.
+        PathEdges result = mEdgeCache.front().edges;
+        placeEdges(&result, dx, (int) dy, clipBounds);
+        return result;
+    }
+
+    /**
+     * Move edges built with a path's fractional vertical translation to where
+     * the whole translation puts them, dropping any that end up outside the
+     * clip.
+     *
+     * Args:
+     *     edges:
+     *         The edges and curves to move, in place.
+     *     dx:
+     *         The horizontal translation.
+     *     dy:
+     *         The whole rows of vertical translation.
+     *     clipBounds:
+     *         The device space rectangle that drawing is limited to.
+     */
+    static void placeEdges(PathEdges* edges, float dx, int dy, const GRect& clipBounds) {
+        int top = (int) clipBounds.top();
+        int bottom = (int) clipBounds.bottom();
+
+        for (CurveEdge& curve : edges->curves) {
+            curve.offset(dx, dy);
+        }
+
+        size_t kept = 0;
+        for (Edge edge : edges->edges) {
+            edge.offset(dx, dy);
+
+            if (edge.clipY(top, bottom, edges->curves.data())) {
+                edges->edges[kept++] = edge;
+            }
+        }
+        edges->edges.resize(kept);
+    }
+
+    /**
+     * Check whether a path has been drawn recently without being cached, and
+     * remember it if it hasn't.
+     */
+    bool seenPathBefore(uint32_t pathID) {
+        auto it = std::find(mSeenPathIDs.begin(), mSeenPathIDs.end(), pathID);
+        if (it != mSeenPathIDs.end()) {
+            mSeenPathIDs.erase(it);
+            return true;
+        }
+
+        mSeenPathIDs.push_back(pathID);
+        if (mSeenPathIDs.size() > kSeenPathCount) {
+            mSeenPathIDs.pop_front();
+        }
+
+        return false;
+    }
+
     std::stack<GLayer> mLayers;
+    std::list<MaskCacheEntry> mMaskCache;
+    std::list<EdgeCacheEntry> mEdgeCache;
+    size_t mEdgeCacheBytes = 0;
+    std::deque<uint32_t> mSeenPathIDs;
 };
 
 
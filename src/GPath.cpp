@@ -5,50 +5,132 @@
 #include "GPath.h"
 #include "GMatrix.h"
 
-GPath::GPath() {}
+#include <algorithm>
+
+const std::shared_ptr<GPath::PathRef>& GPath::EmptyRef() {
+    static const std::shared_ptr<PathRef> gEmpty = std::make_shared<PathRef>();
+    return gEmpty;
+}
+
+GPath::GPath() : fRef(EmptyRef()) {}
 GPath::~GPath() {}
 
 GPath& GPath::operator=(const GPath& src) {
-    if (this != &src) {
-        fPts = src.fPts;
-        fVbs = src.fVbs;
-    }
+    fRef = src.fRef;
     return *this;
 }
 
-GPath& GPath::reset() {
+GPath::PathRef::PathRef(const PathRef& src)
+    : fPts(src.fPts)
+    , fVbs(src.fVbs)
+    , fBounds(src.fBounds)
+    , fConvexity(src.fConvexity.load(std::memory_order_relaxed))
+    , fGenerationID(src.fGenerationID.load(std::memory_order_relaxed)) {
+    std::copy(src.fVerbCounts, src.fVerbCounts + kDone, fVerbCounts);
+}
+
+GPath::PathRef* GPath::writableRef() {
+    if (fRef.use_count() != 1) {
+        fRef = std::make_shared<PathRef>(*fRef);
+    }
+    fRef->fGenerationID = 0;
+    return fRef.get();
+}
+
+void GPath::PathRef::appendPoint(GPoint p) {
+    if (fPts.empty()) {
+        fBounds.setLTRB(p.x(), p.y(), p.x(), p.y());
+    } else {
+        fBounds.setLTRB(std::min(fBounds.left(), p.x()), std::min(fBounds.top(), p.y()),
+                        std::max(fBounds.right(), p.x()), std::max(fBounds.bottom(), p.y()));
+    }
+    fPts.push_back(p);
+}
+
+void GPath::PathRef::computeBounds() {
+    if (fPts.empty()) {
+        fBounds = GRect::MakeWH(0, 0);
+        return;
+    }
+
+    fBounds.setLTRB(fPts[0].x(), fPts[0].y(), fPts[0].x(), fPts[0].y());
+    for (const GPoint& p : fPts) {
+        fBounds.setLTRB(std::min(fBounds.left(), p.x()), std::min(fBounds.top(), p.y()),
+                        std::max(fBounds.right(), p.x()), std::max(fBounds.bottom(), p.y()));
+    }
+}
+
+void GPath::PathRef::appendVerb(Verb v) {
+    fVbs.push_back(v);
+    fVerbCounts[v] += 1;
+    fConvexity = kUnknown_Convexity;
+}
+
+void GPath::PathRef::reset() {
+    // clear() keeps the vectors' capacity, so a path that is rebuilt every frame stops
+    // allocating once it has grown to its full size.
     fPts.clear();
     fVbs.clear();
+    fBounds = GRect::MakeWH(0, 0);
+    std::fill(fVerbCounts, fVerbCounts + kDone, 0);
+    fConvexity = kUnknown_Convexity;
+    fGenerationID = 0;
+}
+
+GPath& GPath::reset() {
+    if (fRef.use_count() == 1) {
+        fRef->reset();
+    } else {
+        fRef = EmptyRef();
+    }
+    return *this;
+}
+
+// Still grow geometrically, so that reserving a little at a time doesn't reallocate every time.
+template <typename T> static void grow_by(std::vector<T, GArenaAllocator<T>>& v, size_t extra) {
+    if (v.size() + extra > v.capacity()) {
+        v.reserve(std::max(v.size() + extra, 2 * v.capacity()));
+    }
+}
+
+GPath& GPath::reserve(int points, int verbs) {
+    PathRef* ref = this->writableRef();
+    grow_by(ref->fPts, points);
+    grow_by(ref->fVbs, verbs);
     return *this;
 }
 
 GPath& GPath::moveTo(GPoint p) {
-    fPts.push_back(p);
-    fVbs.push_back(kMove);
+    PathRef* ref = this->writableRef();
+    ref->appendPoint(p);
+    ref->appendVerb(kMove);
     return *this;
 }
 
 GPath& GPath::lineTo(GPoint p) {
-    GASSERT(fVbs.size() > 0);
-    fPts.push_back(p);
-    fVbs.push_back(kLine);
+    GASSERT(fRef->fVbs.size() > 0);
+    PathRef* ref = this->writableRef();
+    ref->appendPoint(p);
+    ref->appendVerb(kLine);
     return *this;
 }
 
 GPath& GPath::quadTo(GPoint p1, GPoint p2) {
-    GASSERT(fVbs.size() > 0);
-    fPts.push_back(p1);
-    fPts.push_back(p2);
-    fVbs.push_back(kQuad);
+    GASSERT(fRef->fVbs.size() > 0);
+    PathRef* ref = this->writableRef();
+    ref->appendPoint(p1);
+    ref->appendPoint(p2);
+    ref->appendVerb(kQuad);
     return *this;
 }
 
 GPath& GPath::cubicTo(GPoint p1, GPoint p2, GPoint p3) {
-    GASSERT(fVbs.size() > 0);
-    fPts.push_back(p1);
-    fPts.push_back(p2);
-    fPts.push_back(p3);
-    fVbs.push_back(kCubic);
+    GASSERT(fRef->fVbs.size() > 0);
+    PathRef* ref = this->writableRef();
+    ref->appendPoint(p1);
+    ref->appendPoint(p2);
+    ref->appendPoint(p3);
+    ref->appendVerb(kCubic);
     return *this;
 }
 
@@ -56,9 +138,9 @@ GPath& GPath::cubicTo(GPoint p1, GPoint p2, GPoint p3) {
 
 GPath::Iter::Iter(const GPath& path) {
     fPrevMove = nullptr;
-    fCurrPt = path.fPts.data();
-    fCurrVb = path.fVbs.data();
-    fStopVb = fCurrVb + path.fVbs.size();
+    fCurrPt = path.fRef->fPts.data();
+    fCurrVb = path.fRef->fVbs.data();
+    fStopVb = fCurrVb + path.fRef->fVbs.size();
 }
 
 GPath::Verb GPath::Iter::next(GPoint pts[]) {
@@ -101,9 +183,9 @@ GPath::Verb GPath::Iter::next(GPoint pts[]) {
 
 GPath::Edger::Edger(const GPath& path) {
     fPrevMove = nullptr;
-    fCurrPt = path.fPts.data();
-    fCurrVb = path.fVbs.data();
-    fStopVb = fCurrVb + path.fVbs.size();
+    fCurrPt = path.fRef->fPts.data();
+    fCurrVb = path.fRef->fVbs.data();
+    fStopVb = fCurrVb + path.fRef->fVbs.size();
     fPrevVerb = kDone;
 }
 